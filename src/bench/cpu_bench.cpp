@@ -0,0 +1,130 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "bench/bench.hpp"
+#include "core/gameboy.hpp"
+#include "core/cpu/cpu.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+// Gives up on ROMs that never report being done
+#define MAX_INSTRS 500000000
+
+#define CLOCK_SPEED 4194304.0 // Clock cycles per second
+#define FRAME_CYCLES 70224     // Clock cycles per frame
+
+struct BenchResult {
+    u64 instrs; // Instructions run, including the ticks spent halted
+    u64 cycles; // Emulated clock cycles
+    u64 idle_cycles; // Skipped over in loops waiting for an event
+    double seconds;
+};
+
+// Reset reuses the ROM that is already loaded, instead of loading it again
+int run_bench(GameBoy &gb, const std::string &rom_path, Cpu::Engine engine, bool reset, BenchResult &result);
+void print_result(const std::string &name, const BenchResult &result);
+
+int cpu_bench(const std::string &rom_path, int runs) {
+    const struct {
+        std::string name;
+        Cpu::Engine engine;
+    } engines[] = {
+        { "switch", Cpu::Engine_Switch },
+        { "table",  Cpu::Engine_Table  }
+    };
+
+    GameBoy gb;
+
+    for (const auto &engine : engines) {
+        BenchResult best;
+        best.seconds = 0.0;
+
+        // Keep the fastest run, as it is the one that was disturbed the least
+        for (int i = 0; i < runs; i++) {
+            BenchResult result;
+
+            // The later runs go through a reset, which has to end up the same as a fresh load
+            if (run_bench(gb, rom_path, engine.engine, i > 0, result) < 0) {
+                std::cout << "Unable to " << (i > 0 ? "reset " : "load ") << rom_path << std::endl;
+                return -1;
+            }
+
+            if (i > 0 && result.cycles != best.cycles) {
+                std::cout << "Resetting " << rom_path << " gave a different result than loading it" << std::endl;
+                return -1;
+            }
+
+            if (best.seconds == 0.0 || result.seconds < best.seconds)
+                best = result;
+        }
+
+        print_result(engine.name, best);
+    }
+
+    return 0;
+}
+
+int run_bench(GameBoy &gb, const std::string &rom_path, Cpu::Engine engine, bool reset, BenchResult &result) {
+    std::string error;
+
+    if (reset) {
+        if (gb.reset() < 0)
+            return -1;
+    }
+
+    else if (gb.load_rom(rom_path, error) < 0)
+        return -1;
+
+    gb.init();
+    gb.cpu->set_engine(engine);
+
+    result.instrs = 0;
+
+    auto time_start = std::chrono::steady_clock::now();
+
+    while (result.instrs < MAX_INSTRS) {
+        // Checking if the ROM is done costs a few memory reads, so only do it every so often
+        for (int i = 0; i < 1024; i++)
+            gb.cpu->step();
+
+        result.instrs += 1024;
+
+        if (gb.cpu->is_blargg_done() || gb.cpu->is_mooneye_done())
+            break;
+    }
+
+    auto time_end = std::chrono::steady_clock::now();
+
+    result.cycles  = gb.cpu->get_cycles();
+    result.idle_cycles = gb.cpu->get_idle_cycles();
+    result.seconds = std::chrono::duration<double>(time_end - time_start).count();
+
+    return 0;
+}
+
+void print_result(const std::string &name, const BenchResult &result) {
+    double mips  = result.instrs / result.seconds / 1000000.0;
+    double speed = result.cycles / result.seconds / CLOCK_SPEED;
+    double fps   = result.cycles / result.seconds / FRAME_CYCLES;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::left << std::setw(8) << name
+              << result.instrs << " instructions in " << result.seconds << " sec, "
+              << mips << " MIPS, " << fps << " fps, " << speed << "x real-time, "
+              << 100.0 * result.idle_cycles / result.cycles << "% idle" << std::endl;
+}
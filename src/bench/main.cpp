@@ -0,0 +1,50 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "bench/bench.hpp"
+#include "common/logger.hpp"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+int main(int argc, char **argv) {
+    bool rewind = argc > 1 && std::strcmp(argv[1], "--rewind") == 0;
+
+    if (rewind) {
+        argc--;
+        argv++;
+    }
+
+    if (argc != 2 && argc != 3) {
+        std::cout << "Usage: Azayaka-bench [--rewind] <ROM Path> [Runs]" << std::endl;
+        return -1;
+    }
+
+    int runs = 3;
+    if (argc == 3)
+        runs = std::atoi(argv[2]);
+
+    if (runs < 1)
+        runs = 1;
+
+    Logger::get_instance().enable(0);
+
+    if (rewind)
+        return rewind_bench(std::string(argv[1]), runs);
+
+    return cpu_bench(std::string(argv[1]), runs);
+}
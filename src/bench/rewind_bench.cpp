@@ -0,0 +1,291 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "bench/bench.hpp"
+#include "core/gameboy.hpp"
+#include "core/state.hpp"
+#include "core/rewind_codec.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define NUM_OF_FRAMES 1200 // 20 seconds worth of states
+#define FRAMES_PER_KEY 255
+
+struct Codec {
+    std::string name;
+
+    std::function<void(const u8 *key, const State &state, std::vector <u8> &out)> compress;
+    std::function<void(const u8 *key, const std::vector <u8> &in, State &state, unsigned int size)> decompress;
+};
+
+struct CodecResult {
+    u64 bytes;      // Uncompressed
+    u64 compressed;
+    double compress_seconds;
+    double decompress_seconds;
+    bool matches;   // Every state came back the same
+};
+
+// The codec the rewinder used before RewindCodec, which went one byte at a time
+void reference_compress  (const u8 *key, const State &state, std::vector <u8> &out);
+void reference_decompress(const u8 *key, const std::vector <u8> &in, State &state);
+
+void run_codec(const Codec &codec, const std::vector <State> &states, CodecResult &result);
+void print_codec(const std::string &name, const CodecResult &result);
+
+int rewind_bench(const std::string &rom_path, int runs) {
+    GameBoy gb;
+    std::string error;
+
+    if (gb.load_rom(rom_path, error) < 0) {
+        std::cout << "Unable to load " << rom_path << std::endl;
+        return -1;
+    }
+
+    gb.init();
+
+    std::vector <State> states(NUM_OF_FRAMES);
+
+    for (State &state : states) {
+        gb.run_frame();
+        gb.save_state(state);
+    }
+
+    std::vector <Codec> codecs;
+
+    codecs.push_back({
+        "reference",
+        [](const u8 *key, const State &state, std::vector <u8> &out) {
+            reference_compress(key, state, out);
+        },
+        [](const u8 *key, const std::vector <u8> &in, State &state, unsigned int) {
+            reference_decompress(key, in, state);
+        }
+    });
+
+    const RewindCodec::Impl impls[] = {
+        RewindCodec::Impl_Scalar,
+        RewindCodec::Impl_Sse2,
+        RewindCodec::Impl_Avx2
+    };
+
+    // Shared by the lambdas below, only one of them runs at a time
+    RewindCodec rewind_codec;
+
+    for (RewindCodec::Impl impl : impls) {
+        if (!RewindCodec::is_supported(impl))
+            continue;
+
+        codecs.push_back({
+            RewindCodec::get_impl_name(impl),
+            [&rewind_codec, impl](const u8 *key, const State &state, std::vector <u8> &out) {
+                rewind_codec.set_impl(impl);
+                rewind_codec.compress(key, state.get_data(), state.size(), out);
+            },
+            [&rewind_codec, impl](const u8 *key, const std::vector <u8> &in, State &state, unsigned int size) {
+                rewind_codec.set_impl(impl);
+                rewind_codec.decompress(key, in.data(), in.size(), state.append(size), size);
+            }
+        });
+    }
+
+    std::cout << states.size() << " states of " << states[0].size() << " bytes" << std::endl;
+
+    for (const Codec &codec : codecs) {
+        CodecResult best;
+        best.compress_seconds = 0.0;
+
+        // Keep the fastest run, as it is the one that was disturbed the least
+        for (int i = 0; i < runs; i++) {
+            CodecResult result;
+            run_codec(codec, states, result);
+
+            if (best.compress_seconds == 0.0 || result.compress_seconds + result.decompress_seconds <
+                best.compress_seconds + best.decompress_seconds)
+                best = result;
+        }
+
+        print_codec(codec.name, best);
+    }
+
+    return 0;
+}
+
+void run_codec(const Codec &codec, const std::vector <State> &states, CodecResult &result) {
+    const unsigned int frames_per_key = FRAMES_PER_KEY;
+
+    std::vector <std::vector <u8>> compressed(states.size());
+
+    result.bytes      = 0;
+    result.compressed = 0;
+    result.matches    = true;
+
+    // Every state is compressed against the key state of its series, like the rewinder does
+    auto time_start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < states.size(); i++) {
+        if (i % frames_per_key == 0)
+            continue;
+
+        codec.compress(states[i - i % frames_per_key].get_data(), states[i], compressed[i]);
+    }
+
+    auto time_end = std::chrono::steady_clock::now();
+    result.compress_seconds = std::chrono::duration<double>(time_end - time_start).count();
+
+    State state;
+    double seconds = 0.0;
+
+    for (unsigned int i = 0; i < states.size(); i++) {
+        if (i % frames_per_key == 0)
+            continue;
+
+        state.clear();
+
+        time_start = std::chrono::steady_clock::now();
+        codec.decompress(states[i - i % frames_per_key].get_data(), compressed[i], state, states[i].size());
+        time_end = std::chrono::steady_clock::now();
+
+        seconds += std::chrono::duration<double>(time_end - time_start).count();
+
+        if (state.size() != states[i].size() || std::memcmp(state.get_data(), states[i].get_data(), state.size()) != 0)
+            result.matches = false;
+
+        result.bytes      += states[i].size();
+        result.compressed += compressed[i].size();
+    }
+
+    result.decompress_seconds = seconds;
+}
+
+void print_codec(const std::string &name, const CodecResult &result) {
+    double ratio = static_cast<double>(result.bytes) / result.compressed;
+    double compress_speed   = result.bytes / result.compress_seconds   / (1024.0 * 1024.0);
+    double decompress_speed = result.bytes / result.decompress_seconds / (1024.0 * 1024.0);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::left << std::setw(10) << name
+              << "ratio " << ratio << ":1, "
+              << "compress " << compress_speed << " MB/sec, "
+              << "decompress " << decompress_speed << " MB/sec"
+              << (result.matches ? "" : " (states don't match)") << std::endl;
+}
+
+void reference_write_count(std::vector <u8> &out, unsigned int count) {
+    u8 byte;
+
+    do {
+        byte = count & 0x7F;
+        count >>= 7;
+
+        if (count != 0)
+            byte |= 0x80;
+
+        out.push_back(byte);
+    } while(count != 0);
+}
+
+unsigned int reference_read_count(const u8 **data) {
+    unsigned int count = 0;
+    unsigned int shift = 0;
+    u8 byte;
+
+    while (1) {
+        byte = *(*data)++;
+
+        count |= (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            break;
+
+        shift += 7;
+    }
+
+    return count;
+}
+
+void reference_compress(const u8 *key, const State &state, std::vector <u8> &out) {
+    const u8 *prev = key;
+    const u8 *data = state.get_data();
+    const u8 *end  = data + state.size();
+
+    u8 last = *prev++ - *data++;
+    u8 current;
+
+    unsigned int count;
+
+    out.clear();
+    out.push_back(last);
+
+    while (data != end) {
+        current = *prev++ - *data++;
+
+        if (current == last) {
+            count = 0;
+
+            while (data != end) {
+                current = *prev++ - *data++;
+
+                if (current != last)
+                    break;
+
+                count++;
+            }
+
+            out.push_back(last);
+            reference_write_count(out, count);
+
+            if (data == end)
+                break;
+        }
+
+        out.push_back(current);
+        last = current;
+    }
+}
+
+void reference_decompress(const u8 *key, const std::vector <u8> &in, State &state) {
+    const u8 *prev = key;
+    const u8 *data = in.data();
+    const u8 *end  = data + in.size();
+
+    u8 last = *data++;
+    u8 current;
+
+    unsigned int count;
+
+    state.write8(*prev++ - last);
+
+    while (data != end) {
+        current = *data++;
+
+        if (current == last) {
+            count = reference_read_count(&data);
+
+            for (; count > 0; count--)
+                state.write8(*prev++ - current);
+        }
+
+        state.write8(*prev++ - current);
+
+        last = current;
+    }
+}
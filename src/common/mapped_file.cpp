@@ -0,0 +1,84 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "common/mapped_file.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {
+    mapping = nullptr;
+    length  = 0;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+
+    if (fstat(fd, &info) < 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void *address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after the file is closed
+    ::close(fd);
+
+    if (address == MAP_FAILED)
+        return false;
+
+    mapping = static_cast<const u8*>(address);
+    length  = info.st_size;
+#endif
+
+    return is_open();
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (is_open())
+        munmap(const_cast<u8*>(mapping), length);
+#endif
+
+    mapping = nullptr;
+    length  = 0;
+}
+
+bool MappedFile::is_open() const {
+    return mapping != nullptr;
+}
+
+const u8 *MappedFile::data() const {
+    return mapping;
+}
+
+unsigned int MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,158 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// A lock-free queue between exactly one producer thread and one consumer thread.
+//
+// The slots are allocated once, and elements are built and used in place,
+// so large elements (like states) never have to be copied in or out.
+template <typename T>
+class SpscQueue
+{
+public:
+    // One slot is always kept free, to tell a full queue from an empty one
+    SpscQueue(std::size_t capacity) : slots(capacity + 1), head(0), tail(0) {
+    }
+
+    std::size_t capacity() const {
+        return slots.size() - 1;
+    }
+
+    // Producer: Returns the slot to fill in, or nullptr if the queue is full
+    T *begin_push() {
+        std::size_t h = head.load(std::memory_order_relaxed);
+
+        if (next(h) == tail.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &slots[h];
+    }
+
+    // Producer: Hands the slot from begin_push() over to the consumer
+    void end_push() {
+        head.store(next(head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    bool try_push(const T &value) {
+        T *slot = begin_push();
+
+        if (slot == nullptr)
+            return false;
+
+        *slot = value;
+        end_push();
+
+        return true;
+    }
+
+    // Consumer: Returns the oldest element, or nullptr if the queue is empty
+    T *front() {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+
+        if (t == head.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &slots[t];
+    }
+
+    // Consumer: Hands the slot from front() back to the producer
+    void pop() {
+        tail.store(next(tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    bool try_pop(T &value) {
+        T *slot = front();
+
+        if (slot == nullptr)
+            return false;
+
+        value = *slot;
+        pop();
+
+        return true;
+    }
+
+    // Producer: Copies in as many of the values as there is room for, and returns how many that was
+    std::size_t push_bulk(const T *values, std::size_t count) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t t = tail.load(std::memory_order_acquire);
+
+        std::size_t room = (t > h) ? t - h - 1 : t + slots.size() - h - 1;
+        count = std::min(count, room);
+
+        // It might wrap around the end
+        std::size_t first = std::min(count, slots.size() - h);
+
+        std::copy(values, values + first, slots.begin() + h);
+        std::copy(values + first, values + count, slots.begin());
+
+        head.store((h + count) % slots.size(), std::memory_order_release);
+
+        return count;
+    }
+
+    // Consumer: Copies out up to count of the oldest elements, and returns how many that was
+    std::size_t pop_bulk(T *values, std::size_t count) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t h = head.load(std::memory_order_acquire);
+
+        std::size_t used = (h >= t) ? h - t : h + slots.size() - t;
+        count = std::min(count, used);
+
+        std::size_t first = std::min(count, slots.size() - t);
+
+        std::copy(slots.begin() + t, slots.begin() + t + first, values);
+        std::copy(slots.begin(), slots.begin() + (count - first), values + first);
+
+        tail.store((t + count) % slots.size(), std::memory_order_release);
+
+        return count;
+    }
+
+    // Only safe while neither thread is using the queue
+    void clear() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    // Only exact when called from the producer or the consumer while the other is idle
+    bool is_empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t size() const {
+        std::size_t h = head.load(std::memory_order_acquire);
+        std::size_t t = tail.load(std::memory_order_acquire);
+
+        return (h >= t) ? h - t : h + slots.size() - t;
+    }
+
+private:
+    std::size_t next(std::size_t index) const {
+        return (index + 1 == slots.size()) ? 0 : index + 1;
+    }
+
+    std::vector <T> slots;
+
+    // Kept on separate cache lines, so the two threads don't fight over them
+    alignas(64) std::atomic<std::size_t> head; // Written by the producer
+    alignas(64) std::atomic<std::size_t> tail; // Written by the consumer
+};
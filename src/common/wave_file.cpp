@@ -15,6 +15,7 @@
 
 #include "common/wave_file.hpp"
 #include "common/logger.hpp"
+#include "common/endian.hpp"
 
 WaveFile::WaveFile() {
     num_of_samples = 0;
@@ -77,6 +78,17 @@ void WaveFile::write_sample(s16 left, s16 right) {
     num_of_samples++;
 }
 
+void WaveFile::write_samples(const s16 *samples, unsigned int count) {
+    #if IS_BIG_ENDIAN == 1
+        for (unsigned int i = 0; i < count*2; i++)
+            file.write16(samples[i]);
+    #else
+        file.write(samples, count*4);
+    #endif
+
+    num_of_samples += count;
+}
+
 void WaveFile::write4(const char *str) {
     file.write(str, 4);
 }
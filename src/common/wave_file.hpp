@@ -30,6 +30,9 @@ public:
 
     void write_sample(s16 left, s16 right);
 
+    // Writes interleaved stereo samples, count is the number of left/right pairs
+    void write_samples(const s16 *samples, unsigned int count);
+
 private:
     void write4(const char *str);
 
@@ -15,6 +15,7 @@
 
 #include "core/audio/apu.hpp"
 #include "core/gameboy.hpp"
+#include "core/scheduler.hpp"
 #include "core/defs.hpp"
 #include "core/state.hpp"
 #include "core/settings.hpp"
@@ -27,15 +28,21 @@
 #include "core/audio/channel3.hpp"
 #include "core/audio/channel4.hpp"
 
+#include <algorithm>
 #include <iostream>
 
+#define CLOCK_RATE  4194304
+#define SAMPLE_RATE (4194304.0 / 95.0)
+#define FRAME_TICKS 70224 // The samples are made in bulk once a frame
+#define MIX_SCALE   448   // From the 0-60 mix to samples, leaves room for the ~13% overshoot of the filters on a full step
+
 Apu::Apu(GameBoy *gb) : Component(gb) {
     audio_driver = nullptr;
 
-    channels[0] = new Channel1(gb);
-    channels[1] = new Channel2(gb);
-    channels[2] = new Channel3(gb);
-    channels[3] = new Channel4(gb);
+    channels[0] = gb->arena.create<Channel1>(gb);
+    channels[1] = gb->arena.create<Channel2>(gb);
+    channels[2] = gb->arena.create<Channel3>(gb);
+    channels[3] = gb->arena.create<Channel4>(gb);
 
     vin_left_enable = vin_right_enable = 0;
     left_volume = right_volume = 0;
@@ -52,11 +59,28 @@ Apu::Apu(GameBoy *gb) : Component(gb) {
 
     frame_sequencer_counter = 8192;
     frame_sequencer = 0;
+
+    left_buffer .set_rates(CLOCK_RATE, SAMPLE_RATE, FRAME_TICKS);
+    right_buffer.set_rates(CLOCK_RATE, SAMPLE_RATE, FRAME_TICKS);
+
+    // Room for a frame of stereo samples
+    samples.resize((int)(FRAME_TICKS * SAMPLE_RATE / CLOCK_RATE + 2) * 2);
+
+    // Until the settings are loaded
+    resampler.set_rates(SAMPLE_RATE, 44100);
+
+    band_limited = true;
+    reset_mix();
 }
 
 Apu::~Apu() {
     for (int i = 0; i < 4; i++)
-        delete channels[i];
+        MemoryArena::destroy(channels[i]);
+}
+
+std::size_t Apu::arena_size() {
+    return MemoryArena::size_of<Channel1>() + MemoryArena::size_of<Channel2>() +
+           MemoryArena::size_of<Channel3>() + MemoryArena::size_of<Channel4>();
 }
 
 void Apu::bind_audio_driver(AudioDriver *audio_driver) {
@@ -64,87 +88,241 @@ void Apu::bind_audio_driver(AudioDriver *audio_driver) {
 }
 
 void Apu::tick() {
-    if (--frame_sequencer_counter <= 0) {
-        frame_sequencer_counter = 8192;
-
-        switch (frame_sequencer) {
-            case 0:
-                channels[0]->length_clock();
-                channels[1]->length_clock();
-                channels[2]->length_clock();
-                channels[3]->length_clock();
-                break;
-
-            case 1:
-                break;
-
-            case 2:
-                channels[0]->sweep_clock ();
-                channels[0]->length_clock();
-                channels[1]->length_clock();
-                channels[2]->length_clock();
-                channels[3]->length_clock();
-                break;
-
-            case 3:
-                break;
-
-            case 4:
-                channels[0]->length_clock();
-                channels[1]->length_clock();
-                channels[2]->length_clock();
-                channels[3]->length_clock();
-                break;
-
-            case 5:
-                break;
-
-            case 6:
-                channels[0]->sweep_clock ();
-                channels[0]->length_clock();
-                channels[1]->length_clock();
-                channels[2]->length_clock();
-                channels[3]->length_clock();
-                break;
-
-            case 7:
-                channels[0]->envelope_clock();
-                channels[1]->envelope_clock();
-                channels[3]->envelope_clock();
-                break;
+    advance(1);
+}
+
+void Apu::advance(int ticks) {
+    if (band_limited) {
+        advance_band_limited(ticks);
+        return;
+    }
+
+    while (ticks > 0) {
+        // Run up to the next frame-sequencer step or sample, whichever comes first
+        int step = std::min({ticks, std::max(frame_sequencer_counter, 1), std::max(frequency_counter, 1)});
+
+        ticks -= step;
+        frame_sequencer_counter -= step;
+        frequency_counter       -= step;
+
+        if (frame_sequencer_counter <= 0) {
+            // The frame-sequencer is clocked at the start of the last tick
+            for (Channel *channel : channels)
+                channel->advance(step - 1);
+
+            clock_frame_sequencer();
+
+            for (Channel *channel : channels)
+                channel->advance(1);
         }
 
-        frame_sequencer = (frame_sequencer + 1) & 7;
+        else {
+            for (Channel *channel : channels)
+                channel->advance(step);
+        }
 
-        channels[0]->set_frame_sequencer(frame_sequencer);
-        channels[1]->set_frame_sequencer(frame_sequencer);
-        channels[2]->set_frame_sequencer(frame_sequencer);
-        channels[3]->set_frame_sequencer(frame_sequencer);
+        if (frequency_counter <= 0)
+            mix_sample();
     }
+}
 
-    channels[0]->tick();
-    channels[1]->tick();
-    channels[2]->tick();
-    channels[3]->tick();
+void Apu::advance_band_limited(int ticks) {
+    while (ticks > 0) {
+        // Run up to the next frame-sequencer step, the end of the frame, or a change in output
+        int step = std::min({ticks, std::max(frame_sequencer_counter, 1), (int)(FRAME_TICKS - frame_time)});
 
-    if (--frequency_counter <= 0) {
-        frequency_counter = 95;
+        for (Channel *channel : channels)
+            step = std::min(step, channel->ticks_to_change());
 
-        int left = 0, right = 0;
-        byte output;
+        ticks -= step;
+        frame_sequencer_counter -= step;
 
-        for (int i = 0; i < 4; i++) {
-            output = channels[i]->get_output() * volume[i];
+        if (frame_sequencer_counter <= 0) {
+            // The frame-sequencer is clocked at the start of the last tick
+            for (Channel *channel : channels)
+                channel->advance(step - 1);
 
-            if (left_enables[i])
-                left += output;
-            if (right_enables[i])
-                right += output;
+            clock_frame_sequencer();
+
+            for (Channel *channel : channels)
+                channel->advance(1);
+        }
+
+        else {
+            for (Channel *channel : channels)
+                channel->advance(step);
         }
 
-        if (audio_driver != nullptr)
-            audio_driver->add_sample(convert_sample(left), convert_sample(right));
+        frame_time += step;
+        update_mix();
+
+        if (frame_time >= FRAME_TICKS)
+            end_frame();
+    }
+}
+
+int Apu::next_event() const {
+    // Nothing outside of the APU depends on it
+    return Scheduler::NoEvent;
+}
+
+void Apu::clock_frame_sequencer() {
+    frame_sequencer_counter = 8192;
+
+    switch (frame_sequencer) {
+        case 0:
+            channels[0]->length_clock();
+            channels[1]->length_clock();
+            channels[2]->length_clock();
+            channels[3]->length_clock();
+            break;
+
+        case 1:
+            break;
+
+        case 2:
+            channels[0]->sweep_clock ();
+            channels[0]->length_clock();
+            channels[1]->length_clock();
+            channels[2]->length_clock();
+            channels[3]->length_clock();
+            break;
+
+        case 3:
+            break;
+
+        case 4:
+            channels[0]->length_clock();
+            channels[1]->length_clock();
+            channels[2]->length_clock();
+            channels[3]->length_clock();
+            break;
+
+        case 5:
+            break;
+
+        case 6:
+            channels[0]->sweep_clock ();
+            channels[0]->length_clock();
+            channels[1]->length_clock();
+            channels[2]->length_clock();
+            channels[3]->length_clock();
+            break;
+
+        case 7:
+            channels[0]->envelope_clock();
+            channels[1]->envelope_clock();
+            channels[3]->envelope_clock();
+            break;
+    }
+
+    frame_sequencer = (frame_sequencer + 1) & 7;
+
+    channels[0]->set_frame_sequencer(frame_sequencer);
+    channels[1]->set_frame_sequencer(frame_sequencer);
+    channels[2]->set_frame_sequencer(frame_sequencer);
+    channels[3]->set_frame_sequencer(frame_sequencer);
+}
+
+void Apu::mix_sample() {
+    frequency_counter = 95;
+
+    int left = 0, right = 0;
+    byte output;
+
+    for (int i = 0; i < 4; i++) {
+        output = channels[i]->get_output() * volume[i];
+
+        if (left_enables[i])
+            left += output;
+        if (right_enables[i])
+            right += output;
+    }
+
+    samples[sample_count*2]     = convert_sample(left);
+    samples[sample_count*2 + 1] = convert_sample(right);
+
+    // Send them off in blocks of about a frame
+    if (++sample_count * 2 == (int)samples.size())
+        output_samples(sample_count);
+}
+
+void Apu::update_mix() {
+    int left = 0, right = 0;
+
+    for (int i = 0; i < 4; i++) {
+        byte output = channels[i]->get_output() * volume[i];
+
+        if (left_enables[i])
+            left += output;
+        if (right_enables[i])
+            right += output;
+    }
+
+    // The DC offset is taken out by the buffers
+    if (left != left_mix) {
+        left_buffer.add_delta(frame_time, (left - left_mix) * MIX_SCALE);
+        left_mix = left;
+    }
+
+    if (right != right_mix) {
+        right_buffer.add_delta(frame_time, (right - right_mix) * MIX_SCALE);
+        right_mix = right;
+    }
+}
+
+void Apu::end_frame() {
+    left_buffer .end_frame(frame_time);
+    right_buffer.end_frame(frame_time);
+
+    frame_time = 0;
+
+    int count = left_buffer.samples_avail();
+
+    left_buffer .read_samples(&samples[0], count, 2);
+    right_buffer.read_samples(&samples[1], count, 2);
+
+    output_samples(count);
+}
+
+void Apu::output_samples(int count) {
+    sample_count = 0;
+
+    if (audio_driver != nullptr) {
+        // The device might not have opened at the rate in the settings
+        if (audio_driver->get_sample_rate() > 0)
+            resampler.set_rates(SAMPLE_RATE, audio_driver->get_sample_rate());
+
+        // Dynamic rate control, keeps the audio in step when nothing else is
+        resampler.set_ratio_adjust(audio_driver->get_rate_adjust());
     }
+
+    int frames = resampler.process(&samples[0], count, resampled);
+
+    if (audio_driver != nullptr && frames > 0)
+        audio_driver->submit(&resampled[0], frames);
+}
+
+void Apu::reset_mix() {
+    left_buffer .clear();
+    right_buffer.clear();
+
+    sample_count = 0;
+    resampler.clear();
+
+    frame_time = 0;
+    left_mix = right_mix = 0;
+
+    update_mix();
+}
+
+void Apu::set_band_limited(bool band_limited) {
+    if (this->band_limited == band_limited)
+        return;
+
+    this->band_limited = band_limited;
+
+    reset_mix();
 }
 
 byte Apu::read(word address) {
@@ -198,6 +376,14 @@ byte Apu::read(word address) {
 }
 
 void Apu::write(word address, byte value) {
+    write_register(address, value);
+
+    // Volume, panning, triggers and power can all change the output right away
+    if (band_limited)
+        update_mix();
+}
+
+void Apu::write_register(word address, byte value) {
     if (address == 0xFF26) {
         bool enable = (value & BIT7) != 0;
 
@@ -331,6 +517,8 @@ void Apu::load_state(State &state) {
     frequency_counter       = state.read32();
     frame_sequencer_counter = state.read32();
     frame_sequencer         = state.read32();
+
+    reset_mix();
 }
 
 void Apu::load_settings(Settings &settings) {
@@ -338,6 +526,14 @@ void Apu::load_settings(Settings &settings) {
     volume[1] = settings.audio_channel2_volume / 100.0f;
     volume[2] = settings.audio_channel3_volume / 100.0f;
     volume[3] = settings.audio_channel4_volume / 100.0f;
+
+    set_band_limited(settings.audio_band_limited);
+
+    resampler.set_rates(SAMPLE_RATE, settings.audio_sample_rate);
+    resampler.set_quality((Resampler::Quality)std::min(settings.audio_resampler_quality, (unsigned int)Resampler::Quality_High));
+
+    if (band_limited)
+        update_mix();
 }
 
 void Apu::clear_regs() {
@@ -356,5 +552,6 @@ void Apu::clear_regs() {
 }
 
 s16 Apu::convert_sample(s16 sample) {
-    return (sample-32) << 10;
+    // The same scale as the band-limited mix, the resampler rings on the hard steps
+    return (sample-32) * MIX_SCALE;
 }
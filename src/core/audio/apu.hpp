@@ -18,6 +18,11 @@
 #include "core/component.hpp"
 #include "core/types.hpp"
 #include "core/audio/channel.hpp"
+#include "core/audio/blip_buffer.hpp"
+#include "core/audio/resampler.hpp"
+
+#include <cstddef>
+#include <vector>
 
 class AudioDriver;
 class State;
@@ -29,9 +34,15 @@ public:
     Apu(GameBoy *gb);
     ~Apu();
 
+    // What it allocates out of the GameBoy's arena
+    static std::size_t arena_size();
+
     void bind_audio_driver(AudioDriver *audio_driver);
 
     void tick();
+    void advance(int ticks);
+
+    int next_event() const;
 
     byte read(word address) override;
     void write(word address, byte value) override;
@@ -41,7 +52,25 @@ public:
 
     void load_settings(Settings &settings);
 
+    // Instead of sampling the channels every so many ticks, only run them up to where their
+    // output changes, and turn those changes into samples with a band-limited step
+    void set_band_limited(bool band_limited);
+
 private:
+    void write_register(word address, byte value);
+
+    void advance_band_limited(int ticks);
+    void clock_frame_sequencer();
+    void mix_sample();
+
+    // Adds the change in the mix since the last time, at the current time
+    void update_mix();
+    void end_frame();
+    void reset_mix();
+
+    // Resamples the first count stereo samples to the output rate, and sends them to the audio driver
+    void output_samples(int count);
+
     void clear_regs();
     s16 convert_sample(s16 sample);
 
@@ -60,5 +89,15 @@ private:
     int frame_sequencer_counter;
     int frame_sequencer;
 
+    bool band_limited;
+    BlipBuffer left_buffer, right_buffer;
+    unsigned int frame_time;
+    int left_mix, right_mix;
+    std::vector <s16> samples;
+    int sample_count;
+
+    Resampler resampler;
+    std::vector <s16> resampled;
+
     AudioDriver *audio_driver;
 };
@@ -17,9 +17,17 @@
 #include "common/logger.hpp"
 #include "core/settings.hpp"
 
+#include <algorithm>
 #include <cmath>
 
+#define MAX_RATE_ADJUST 0.005 // Small enough that the change in pitch can't be heard
+#define FILL_SMOOTHING  0.05  // How quickly the average fill follows the latest one
+
 AudioDriver::AudioDriver() {
+    // Until the driver is started
+    sample_rate = 0;
+    buffer_size = 0;
+
     mode = Mode_Normal;
     skip = false;
 
@@ -28,61 +36,65 @@ AudioDriver::AudioDriver() {
     dump_audio = false;
 
     sync_to_audio = 1;
-}
 
-void AudioDriver::add_sample(s16 left, s16 right) {
-    left  *= volume;
-    right *= volume;
+    dynamic_rate = true;
+    rate_adjust  = 0.0;
+    average_fill = 0.0;
+}
 
-    // Yes, I know that this is really ugly, and contains a lot of
-    // code-duplication but I am kinda uncreative and I couldn't think
-    // of any better methods to do this that are reasonably fast...
+void AudioDriver::submit(const s16 *samples, std::size_t frames) {
+    // Slow-motion doubles the number of frames
+    if (block.size() < frames * 4)
+        block.resize(frames * 4);
 
-    if (dump_audio) {
-        switch (mode) {
-            case Mode_Normal:
-                internal_add_sample(left, right);
-                wave_file.write_sample(left, right);
-                break;
+    s16 *out = &block[0];
 
-            case Mode_SlowMotion:
-                internal_add_sample(left, right);
-                internal_add_sample(left, right);
+    // The volume is in fixed point, so that the loop is just multiplies and shifts
+    const int gain = std::lround(volume * 32768.0f);
 
-                wave_file.write_sample(left, right);
-                wave_file.write_sample(left, right);
-                break;
+    std::size_t count = frames * 2;
 
-            case Mode_Turbo:
-                skip = !skip;
+    switch (mode) {
+        case Mode_Normal:
+            for (std::size_t i = 0; i < count; i++)
+                out[i] = (samples[i] * gain) >> 15;
+            break;
 
-                if (skip) {
-                    internal_add_sample(left, right);
-                    wave_file.write_sample(left, right);
-                }
-                break;
-        }
-    }
+        case Mode_SlowMotion:
+            // Every frame is played twice
+            for (std::size_t i = 0; i < count; i += 2) {
+                s16 left  = (samples[i]     * gain) >> 15;
+                s16 right = (samples[i + 1] * gain) >> 15;
+
+                out[i*2]     = left;
+                out[i*2 + 1] = right;
+                out[i*2 + 2] = left;
+                out[i*2 + 3] = right;
+            }
+
+            count *= 2;
+            break;
 
-    else {
-        switch (mode) {
-            case Mode_Normal:
-                internal_add_sample(left, right);
-                break;
+        case Mode_Turbo:
+            // Every other frame is dropped, carrying on from where the last block left off
+            for (std::size_t i = skip ? 2 : 0, j = 0; i < count; i += 4, j += 2) {
+                out[j]     = (samples[i]     * gain) >> 15;
+                out[j + 1] = (samples[i + 1] * gain) >> 15;
+            }
 
-            case Mode_SlowMotion:
-                internal_add_sample(left, right);
-                internal_add_sample(left, right);
-                break;
+            count = (frames + (skip ? 0 : 1)) / 2 * 2;
 
-            case Mode_Turbo:
+            if (frames & 1)
                 skip = !skip;
-
-                if (skip)
-                    internal_add_sample(left, right);
-                break;
-        }
+            break;
     }
+
+    update_rate_control();
+
+    if (dump_audio)
+        wave_file.write_samples(out, count / 2);
+
+    internal_submit(out, count / 2);
 }
 
 int AudioDriver::start_dumping_audio(const std::string &file_path) {
@@ -128,6 +140,9 @@ bool AudioDriver::get_sync_to_audio() const {
 
 void AudioDriver::reset() {
     mode = Mode_Normal;
+
+    rate_adjust  = 0.0;
+    average_fill = 0.0;
 }
 
 void AudioDriver::set_mode(Mode mode) {
@@ -148,6 +163,10 @@ void AudioDriver::set_mode(Mode mode) {
     }
 }
 
+AudioDriver::Mode AudioDriver::get_mode() const {
+    return mode;
+}
+
 int AudioDriver::get_volume() const {
     return round(volume * 100.0f);
 }
@@ -162,6 +181,44 @@ void AudioDriver::load_settings(Settings &settings) {
 
     volume = settings.audio_master_volume / 100.0f;
     sync_to_audio = settings.emu_sync_to_audio;
+    dynamic_rate  = settings.audio_dynamic_rate;
+
+    rate_adjust  = 0.0;
+    average_fill = 0.0;
+}
+
+AudioDriver::BufferStats AudioDriver::get_buffer_stats() const {
+    BufferStats stats;
+
+    stats.fill      = 0;
+    stats.capacity  = 0;
+    stats.underruns = 0;
+    stats.overruns  = 0;
+
+    return stats;
+}
+
+double AudioDriver::get_rate_adjust() const {
+    return rate_adjust;
+}
+
+void AudioDriver::update_rate_control() {
+    BufferStats stats = get_buffer_stats();
+
+    // Syncing to audio already holds the buffer where it should be, by waiting on it
+    if (!dynamic_rate || sync_to_audio || stats.capacity == 0) {
+        rate_adjust = 0.0;
+        return;
+    }
+
+    average_fill += (stats.fill - average_fill) * FILL_SMOOTHING;
+
+    // Aim for two device buffers to be left when each block arrives. Being a buffer
+    // away from that uses the whole adjustment, so that even when the device clock is
+    // off by the limit there is still one buffer left.
+    double target = buffer_size * 2.0;
+
+    rate_adjust = std::clamp((target - average_fill) / buffer_size, -1.0, 1.0) * MAX_RATE_ADJUST;
 }
 
 void AudioDriver::set_volume(float volume) {
@@ -18,6 +18,7 @@
 #include "core/types.hpp"
 #include "common/wave_file.hpp"
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -34,7 +35,8 @@ public:
 
     virtual void pause(bool value) = 0;
 
-    void add_sample(s16 left, s16 right);
+    // Takes a block of interleaved stereo samples, frames is the number of left/right pairs
+    void submit(const s16 *samples, std::size_t frames);
 
     virtual void set_sync_to_audio(bool sync_to_audio) = 0;
 
@@ -57,6 +59,7 @@ public:
     };
 
     void set_mode(Mode mode);
+    Mode get_mode() const;
 
     // Volume is a number ranging from 0 to 100
     int get_volume() const;
@@ -65,18 +68,33 @@ public:
 
     void load_settings(Settings &settings);
 
+    // How full the driver's own buffer is, and how often it has run dry or overflowed.
+    // Drivers that hand the samples straight to the device report zeros.
+    struct BufferStats {
+        unsigned int fill;      // In frames
+        unsigned int capacity;  // In frames
+        unsigned int underruns; // Times the device asked for more frames than there were
+        unsigned int overruns;  // Times a block didn't fit, and frames were dropped
+    };
+
+    virtual BufferStats get_buffer_stats() const;
+
+    // How many more (or fewer, if negative) samples should be made, as a fraction,
+    // to keep the buffer at its target fill when the emulation isn't synced to audio
+    double get_rate_adjust() const;
+
 protected:
-    virtual void internal_add_sample(s16 left, s16 right) = 0;
+    // Gets the samples after the volume and mode have been applied
+    virtual void internal_submit(const s16 *samples, std::size_t frames) = 0;
 
     unsigned int sample_rate;
     unsigned int buffer_size;
 
     bool sync_to_audio;
 
-    std::vector <s16> audio_buffer;
-
 private:
     void set_volume(float volume);
+    void update_rate_control();
 
     Mode mode;
     bool skip;
@@ -84,4 +102,10 @@ private:
 
     WaveFile wave_file;
     bool dump_audio;
+
+    std::vector <s16> block;
+
+    bool dynamic_rate;
+    double rate_adjust;
+    double average_fill; // In frames, taken just before each block is added
 };
@@ -0,0 +1,148 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/audio/blip_buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#define FRAC_BITS  32
+#define PHASE_BITS 6
+#define PHASES     (1 << PHASE_BITS)
+#define TAPS       16
+#define KERNEL_BITS 14 // Each phase of the kernel adds up to (1 << KERNEL_BITS)
+#define BASS_SHIFT  9  // How quickly the DC offset is removed
+
+namespace {
+
+// The impulse of a band-limited step, one row per fraction of a sample
+struct Kernel {
+    s32 taps[PHASES][TAPS];
+};
+
+Kernel make_kernel() {
+    Kernel kernel;
+
+    const double pi     = 3.14159265358979323846;
+    const double cutoff = 0.9; // Of the nyquist frequency
+
+    for (int phase = 0; phase < PHASES; phase++) {
+        double impulse[TAPS];
+        double total = 0.0;
+
+        for (int tap = 0; tap < TAPS; tap++) {
+            double x = tap - (TAPS/2 - 1) - (double)phase / PHASES;
+
+            double sinc   = (x == 0.0) ? 1.0 : std::sin(pi * x * cutoff) / (pi * x * cutoff);
+            double window = 0.42 + 0.5 * std::cos(2.0 * pi * x / TAPS) + 0.08 * std::cos(4.0 * pi * x / TAPS); // Blackman
+
+            impulse[tap] = sinc * window;
+            total += impulse[tap];
+        }
+
+        // Make sure every phase adds up to exactly one, otherwise the output would drift
+        s32 sum = 0;
+
+        for (int tap = 0; tap < TAPS; tap++) {
+            kernel.taps[phase][tap] = std::lround(impulse[tap] / total * (1 << KERNEL_BITS));
+            sum += kernel.taps[phase][tap];
+        }
+
+        kernel.taps[phase][TAPS/2 - 1] += (1 << KERNEL_BITS) - sum;
+    }
+
+    return kernel;
+}
+
+// Built the first time it is used, which is thread-safe, since GameBoys can be created on several threads at once
+const Kernel &get_kernel() {
+    static const Kernel kernel = make_kernel();
+    return kernel;
+}
+
+}
+
+BlipBuffer::BlipBuffer() {
+    factor = 0;
+    offset = 0;
+
+    avail = 0;
+    integrator = 0;
+}
+
+void BlipBuffer::set_rates(double clock_rate, double sample_rate, unsigned int max_clocks) {
+    factor = std::llround(sample_rate / clock_rate * ((u64)1 << FRAC_BITS));
+
+    buffer.assign(max_clocks * sample_rate / clock_rate + TAPS + 2, 0);
+
+    clear();
+}
+
+void BlipBuffer::clear() {
+    std::fill(buffer.begin(), buffer.end(), 0);
+
+    offset = 0;
+    avail  = 0;
+    integrator = 0;
+}
+
+void BlipBuffer::add_delta(unsigned int time, int delta) {
+    u64 position = time * factor + offset;
+
+    int index = avail + (position >> FRAC_BITS);
+    int phase = (position >> (FRAC_BITS - PHASE_BITS)) & (PHASES - 1);
+
+    s32 *out = &buffer[index];
+    const s32 *in = get_kernel().taps[phase];
+
+    for (int tap = 0; tap < TAPS; tap++)
+        out[tap] += in[tap] * delta;
+}
+
+void BlipBuffer::end_frame(unsigned int time) {
+    offset += time * factor;
+
+    avail  += offset >> FRAC_BITS;
+    offset &= ((u64)1 << FRAC_BITS) - 1;
+}
+
+int BlipBuffer::samples_avail() const {
+    return avail;
+}
+
+int BlipBuffer::read_samples(s16 *out, int count, int stride) {
+    count = std::min(count, avail);
+
+    s32 sum = integrator;
+
+    for (int i = 0; i < count; i++) {
+        out[i * stride] = std::clamp(sum >> KERNEL_BITS, -32768, 32767);
+
+        sum += buffer[i];
+        sum -= sum >> BASS_SHIFT;
+    }
+
+    integrator = sum;
+
+    // Keep the tails of the steps that haven't been read yet
+    int remaining = avail - count + TAPS;
+
+    std::copy(buffer.begin() + count, buffer.begin() + count + remaining, buffer.begin());
+    std::fill(buffer.begin() + remaining, buffer.begin() + count + remaining, 0);
+
+    avail -= count;
+
+    return count;
+}
@@ -0,0 +1,56 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+#include <vector>
+
+// Turns a signal that is only known at the points where it changes into samples,
+// without the aliasing that comes from just taking the value every so many clocks.
+//
+// Every change is added as a band-limited step, spread over the samples around it,
+// and the samples are the running sum of those steps.
+class BlipBuffer
+{
+public:
+    BlipBuffer();
+
+    // The most clocks that can be added before the samples have to be read
+    void set_rates(double clock_rate, double sample_rate, unsigned int max_clocks);
+
+    void clear();
+
+    // The time is in clocks, since the end of the last frame
+    void add_delta(unsigned int time, int delta);
+
+    // Makes the samples up to time available
+    void end_frame(unsigned int time);
+
+    int samples_avail() const;
+
+    // Stride is the distance between the samples in out, so that the channels can be interleaved
+    int read_samples(s16 *out, int count, int stride);
+
+private:
+    u64 factor; // Samples per clock, in fixed point
+    u64 offset; // The fraction of a sample the current frame starts at
+
+    std::vector <s32> buffer;
+    int avail;
+
+    s32 integrator;
+};
@@ -27,9 +27,16 @@ public:
 
     virtual ~Channel() { }
 
-    virtual void tick() = 0;
+    // Runs the channel for the given number of ticks
+    virtual void advance(int ticks) = 0;
     virtual void power_off() = 0;
 
+    // How many ticks until the output could change, the output only ever changes when the timer runs out.
+    // The band-limited mixer only has to run the channel up to there.
+    virtual int ticks_to_change() const = 0;
+
+    static const int NoChange = 0x40000000;
+
     byte get_output() const;
     bool is_enabled() const;
 
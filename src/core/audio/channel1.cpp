@@ -20,6 +20,7 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 Channel1::Channel1(GameBoy *gb) : Channel(gb) {
@@ -99,17 +100,44 @@ void Channel1::write(word address, byte value) {
     LOG_WARNING("Channel1::write can't access address 0x" + StringUtils::hex(address));
 }
 
-void Channel1::tick() {
-    if (--timer <= 0) {
-        timer = (2048 - frequency_sweep.get_frequency()) << 2;
+void Channel1::advance(int ticks) {
+    // The timer is reloaded when it hits zero
+    if (timer > ticks) {
+        timer -= ticks;
+        return;
+    }
+
+    ticks -= std::max(timer, 1);
+
+    int period = (2048 - frequency_sweep.get_frequency()) << 2;
+    int steps  = 1 + ticks / period;
 
-        sequence = (sequence + 1) & 7;
+    timer = period - (ticks % period);
 
-        if (is_enabled())
-            output = duty_table[duty][sequence] ? volume_envelope.get_volume() : 0;
-        else
-            output = 0;
+    sequence = (sequence + steps) & 7;
+
+    if (is_enabled())
+        output = duty_table[duty][sequence] ? volume_envelope.get_volume() : 0;
+    else
+        output = 0;
+}
+
+int Channel1::ticks_to_change() const {
+    int first  = std::max(timer, 1);
+    int period = (2048 - frequency_sweep.get_frequency()) << 2;
+
+    if (!is_enabled())
+        return output ? first : NoChange;
+
+    byte volume = volume_envelope.get_volume();
+
+    for (int i = 0; i < 8; i++) {
+        if ((duty_table[duty][(sequence + 1 + i) & 7] ? volume : 0) != output)
+            return first + i * period;
     }
+
+    // Only a register write or the frame-sequencer can change it now
+    return NoChange;
 }
 
 void Channel1::sweep_clock() {
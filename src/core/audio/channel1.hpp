@@ -27,7 +27,8 @@ public:
     byte read(word address) override;
     void write(word address, byte value) override;
 
-    void tick() override;
+    void advance(int ticks) override;
+    int ticks_to_change() const override;
 
     void sweep_clock() override;
     void envelope_clock() override;
@@ -20,6 +20,8 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
+
 Channel2::Channel2(GameBoy *gb) : Channel(gb) {
     timer     = 0;
     sequence  = 0;
@@ -94,17 +96,44 @@ void Channel2::write(word address, byte value) {
     LOG_WARNING("Channel2::write can't access address 0x" + StringUtils::hex(address));
 }
 
-void Channel2::tick() {
-    if (--timer <= 0) {
-        timer = (2048 - frequency) << 2;
+void Channel2::advance(int ticks) {
+    // The timer is reloaded when it hits zero
+    if (timer > ticks) {
+        timer -= ticks;
+        return;
+    }
+
+    ticks -= std::max(timer, 1);
 
-        sequence = (sequence + 1) & 7;
+    int period = (2048 - frequency) << 2;
+    int steps  = 1 + ticks / period;
 
-        if (is_enabled())
-            output = duty_table[duty][sequence] ? volume_envelope.get_volume() : 0;
-        else
-            output = 0;
+    timer = period - (ticks % period);
+
+    sequence = (sequence + steps) & 7;
+
+    if (is_enabled())
+        output = duty_table[duty][sequence] ? volume_envelope.get_volume() : 0;
+    else
+        output = 0;
+}
+
+int Channel2::ticks_to_change() const {
+    int first  = std::max(timer, 1);
+    int period = (2048 - frequency) << 2;
+
+    if (!is_enabled())
+        return output ? first : NoChange;
+
+    byte volume = volume_envelope.get_volume();
+
+    for (int i = 0; i < 8; i++) {
+        if ((duty_table[duty][(sequence + 1 + i) & 7] ? volume : 0) != output)
+            return first + i * period;
     }
+
+    // Only a register write or the frame-sequencer can change it now
+    return NoChange;
 }
 
 void Channel2::envelope_clock() {
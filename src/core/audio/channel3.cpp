@@ -20,6 +20,8 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
+
 Channel3::Channel3(GameBoy *gb) : Channel(gb) {
     timer    = 0;
     position = 4;
@@ -115,33 +117,66 @@ void Channel3::write(word address, byte value) {
     LOG_WARNING("Channel3::write can't access address 0x" + StringUtils::hex(address));
 }
 
-void Channel3::tick() {
-    ticks_since_read++;
+void Channel3::advance(int ticks) {
+    // The timer is reloaded when it hits zero
+    if (timer > ticks) {
+        timer -= ticks;
+        ticks_since_read += ticks;
+        return;
+    }
 
-    if (--timer <= 0) {
-        timer = (2048 - frequency) << 1;
+    int total = ticks;
 
-        if (is_enabled()) {
-            ticks_since_read = 0;
+    ticks -= std::max(timer, 1);
 
-            last_address = position >> 1;
-            output = wave_table[last_address];
+    int period = (2048 - frequency) << 1;
+    int steps  = 1 + ticks / period;
 
-            if (position & 1)
-                output &= 0x0F;
-            else
-                output >>= 4;
+    timer = period - (ticks % period);
 
-            if (volume_code > 0)
-                output >>= (volume_code - 1);
-            else
-                output = 0;
+    if (is_enabled()) {
+        // Only the last sample read matters
+        position = (position + steps - 1) & 31;
+        ticks_since_read = ticks % period;
 
-            position = (position + 1) & 31;
-        }
-        else
-            output = 0;
+        last_address = position >> 1;
+        output = get_sample(position);
+
+        position = (position + 1) & 31;
+    }
+    else {
+        ticks_since_read += total;
+        output = 0;
+    }
+}
+
+int Channel3::ticks_to_change() const {
+    int first  = std::max(timer, 1);
+    int period = (2048 - frequency) << 1;
+
+    if (!is_enabled())
+        return output ? first : NoChange;
+
+    for (int i = 0; i < 32; i++) {
+        if (get_sample((position + i) & 31) != output)
+            return first + i * period;
     }
+
+    return NoChange;
+}
+
+byte Channel3::get_sample(int position) const {
+    byte sample = wave_table[position >> 1];
+
+    if (position & 1)
+        sample &= 0x0F;
+    else
+        sample >>= 4;
+
+    if (volume_code > 0)
+        return sample >> (volume_code - 1);
+
+    return 0;
 }
 
 void Channel3::power_off() {
@@ -25,9 +25,11 @@ public:
     byte read(word address) override;
     void write(word address, byte value) override;
 
-    void tick() override;
+    void advance(int ticks) override;
     void power_off() override;
 
+    int ticks_to_change() const override;
+
     void save_state(State &state) override;
     void load_state(State &state) override;
 
@@ -36,6 +38,9 @@ private:
 
     void trigger();
 
+    // The output when the given position is played
+    byte get_sample(int position) const;
+
     int timer;
     int position;
     int ticks_since_read;
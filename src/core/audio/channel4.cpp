@@ -20,6 +20,8 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
+
 Channel4::Channel4(GameBoy *gb) : Channel(gb) {
     timer = 0;
 
@@ -96,24 +98,62 @@ void Channel4::write(word address, byte value) {
     LOG_WARNING("Channel4::write can't access address 0x" + StringUtils::hex(address));
 }
 
-void Channel4::tick() {
-    if (--timer <= 0) {
-        timer = divisors[divisor_code] << clock_shift;
+void Channel4::advance(int ticks) {
+    // The timer is reloaded when it hits zero
+    if (timer > ticks) {
+        timer -= ticks;
+        return;
+    }
+
+    ticks -= std::max(timer, 1);
+
+    int period = divisors[divisor_code] << clock_shift;
+    int steps  = 1 + ticks / period;
+
+    timer = period - (ticks % period);
+
+    // The LFSR has to be clocked one step at a time
+    for (int i = 0; i < steps; i++)
+        lfsr = clock_lfsr(lfsr, width_mode);
+
+    if (is_enabled() && (lfsr & 1) == 0)
+        output = volume_envelope.get_volume();
+    else
+        output = 0;
+}
+
+int Channel4::ticks_to_change() const {
+    int first  = std::max(timer, 1);
+    int period = divisors[divisor_code] << clock_shift;
+
+    if (!is_enabled())
+        return output ? first : NoChange;
+
+    byte volume = volume_envelope.get_volume();
+    int next = lfsr;
+
+    // There is no telling when the LFSR will change without running it, so only look a little ahead
+    for (int i = 0; i < 16; i++) {
+        next = clock_lfsr(next, width_mode);
 
-        bool result = ((lfsr & 1) ^ ((lfsr >> 1) & 1)) != 0;
-        lfsr >>= 1;
-        lfsr |= result ? (1 << 14) : 0;
+        if (((next & 1) == 0 ? volume : 0) != output)
+            return first + i * period;
+    }
+
+    return first + 16 * period;
+}
 
-        if (width_mode) {
-            lfsr &= ~BIT6;
-            lfsr |= result ? BIT6 : 0;
-        }
+int Channel4::clock_lfsr(int lfsr, bool width_mode) {
+    bool result = ((lfsr & 1) ^ ((lfsr >> 1) & 1)) != 0;
+    lfsr >>= 1;
+    lfsr |= result ? (1 << 14) : 0;
 
-        if (is_enabled() && (lfsr & 1) == 0)
-            output = volume_envelope.get_volume();
-        else
-            output = 0;
+    if (width_mode) {
+        lfsr &= ~BIT6;
+        lfsr |= result ? BIT6 : 0;
     }
+
+    return lfsr;
 }
 
 void Channel4::envelope_clock() {
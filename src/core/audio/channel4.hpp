@@ -26,16 +26,20 @@ public:
     byte read(word address) override;
     void write(word address, byte value) override;
 
-    void tick() override;
+    void advance(int ticks) override;
     void envelope_clock() override;
     void power_off() override;
 
+    int ticks_to_change() const override;
+
     void save_state(State &state) override;
     void load_state(State &state) override;
 
 private:
     void trigger();
 
+    static int clock_lfsr(int lfsr, bool width_mode);
+
     const int divisors[8] = { 8, 16, 32, 48, 64, 80, 96, 112 };
 
     VolumeEnvelope volume_envelope;
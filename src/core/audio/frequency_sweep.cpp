@@ -84,7 +84,7 @@ byte FrequencySweep::get_nr10() const {
     return (period << 4) | (negate ? BIT3 : 0) | shift;
 }
 
-int FrequencySweep::get_frequency() {
+int FrequencySweep::get_frequency() const {
     return frequency;
 }
 
@@ -36,7 +36,7 @@ public:
 
     byte get_nr10() const;
 
-    int get_frequency();
+    int get_frequency() const;
 
     void trigger();
 
@@ -0,0 +1,306 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/audio/resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#define FRAC_BITS  32
+#define PHASE_BITS 8
+#define PHASES     (1 << PHASE_BITS)
+
+namespace {
+
+// Filters one output frame, the kernel is interpolated between the two phases around it
+struct Taps {
+    const float *left, *right;
+    const float *phase0, *phase1;
+    float frac;
+};
+
+void filter_scalar(const Taps &in, int taps, float &left, float &right) {
+    float l0 = 0.0f, l1 = 0.0f, r0 = 0.0f, r1 = 0.0f;
+
+    for (int i = 0; i < taps; i++) {
+        l0 += in.left [i] * in.phase0[i];
+        l1 += in.left [i] * in.phase1[i];
+        r0 += in.right[i] * in.phase0[i];
+        r1 += in.right[i] * in.phase1[i];
+    }
+
+    left  = l0 + (l1 - l0) * in.frac;
+    right = r0 + (r1 - r0) * in.frac;
+}
+
+#ifdef USE_X86_SIMD
+
+#ifdef __SSE__
+float sum_sse(__m128 values) {
+    values = _mm_add_ps(values, _mm_movehl_ps(values, values));
+    values = _mm_add_ss(values, _mm_shuffle_ps(values, values, 1));
+
+    return _mm_cvtss_f32(values);
+}
+
+void filter_sse(const Taps &in, int taps, float &left, float &right) {
+    __m128 l0 = _mm_setzero_ps(), l1 = _mm_setzero_ps();
+    __m128 r0 = _mm_setzero_ps(), r1 = _mm_setzero_ps();
+
+    // The number of taps is always a multiple of 8
+    for (int i = 0; i < taps; i += 4) {
+        __m128 k0 = _mm_loadu_ps(in.phase0 + i);
+        __m128 k1 = _mm_loadu_ps(in.phase1 + i);
+        __m128 l  = _mm_loadu_ps(in.left  + i);
+        __m128 r  = _mm_loadu_ps(in.right + i);
+
+        l0 = _mm_add_ps(l0, _mm_mul_ps(l, k0));
+        l1 = _mm_add_ps(l1, _mm_mul_ps(l, k1));
+        r0 = _mm_add_ps(r0, _mm_mul_ps(r, k0));
+        r1 = _mm_add_ps(r1, _mm_mul_ps(r, k1));
+    }
+
+    float sl0 = sum_sse(l0), sl1 = sum_sse(l1);
+    float sr0 = sum_sse(r0), sr1 = sum_sse(r1);
+
+    left  = sl0 + (sl1 - sl0) * in.frac;
+    right = sr0 + (sr1 - sr0) * in.frac;
+}
+#endif
+
+__attribute__((target("avx")))
+float sum_avx(__m256 values) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+    return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx")))
+void filter_avx(const Taps &in, int taps, float &left, float &right) {
+    __m256 l0 = _mm256_setzero_ps(), l1 = _mm256_setzero_ps();
+    __m256 r0 = _mm256_setzero_ps(), r1 = _mm256_setzero_ps();
+
+    for (int i = 0; i < taps; i += 8) {
+        __m256 k0 = _mm256_loadu_ps(in.phase0 + i);
+        __m256 k1 = _mm256_loadu_ps(in.phase1 + i);
+        __m256 l  = _mm256_loadu_ps(in.left  + i);
+        __m256 r  = _mm256_loadu_ps(in.right + i);
+
+        l0 = _mm256_add_ps(l0, _mm256_mul_ps(l, k0));
+        l1 = _mm256_add_ps(l1, _mm256_mul_ps(l, k1));
+        r0 = _mm256_add_ps(r0, _mm256_mul_ps(r, k0));
+        r1 = _mm256_add_ps(r1, _mm256_mul_ps(r, k1));
+    }
+
+    float sl0 = sum_avx(l0), sl1 = sum_avx(l1);
+    float sr0 = sum_avx(r0), sr1 = sum_avx(r1);
+
+    left  = sl0 + (sl1 - sl0) * in.frac;
+    right = sr0 + (sr1 - sr0) * in.frac;
+}
+
+#endif // USE_X86_SIMD
+
+typedef void (*FilterFunc)(const Taps &in, int taps, float &left, float &right);
+
+FilterFunc pick_filter() {
+#ifdef USE_X86_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx"))
+        return filter_avx;
+
+#ifdef __SSE__
+    return filter_sse;
+#endif
+#endif
+
+    return filter_scalar;
+}
+
+s16 to_sample(float value) {
+    return std::clamp((int)std::lrint(value), -32768, 32767);
+}
+
+}
+
+Resampler::Resampler() {
+    input_rate = output_rate = 44100.0;
+    adjust = 0.0;
+
+    quality = Quality_High;
+    taps = 32;
+
+    position = 0;
+    step = (u64)1 << FRAC_BITS;
+
+    make_kernel();
+}
+
+void Resampler::set_rates(double input_rate, double output_rate) {
+    if (this->input_rate == input_rate && this->output_rate == output_rate)
+        return;
+
+    this->input_rate  = input_rate;
+    this->output_rate = output_rate;
+
+    // The cutoff depends on the ratio
+    make_kernel();
+    update_step();
+}
+
+void Resampler::set_quality(Quality quality) {
+    if (this->quality == quality)
+        return;
+
+    this->quality = quality;
+
+    make_kernel();
+}
+
+void Resampler::set_ratio_adjust(double adjust) {
+    this->adjust = adjust;
+
+    update_step();
+}
+
+void Resampler::clear() {
+    position = 0;
+
+    left .clear();
+    right.clear();
+}
+
+int Resampler::process(const s16 *in, int frames, std::vector <s16> &out) {
+    static const FilterFunc filter = pick_filter();
+
+    // Start off with a history of silence, so that the first output is centered on the first input
+    if (left.empty()) {
+        left .assign(taps/2 - 1, 0.0f);
+        right.assign(taps/2 - 1, 0.0f);
+    }
+
+    for (int i = 0; i < frames; i++) {
+        left .push_back(in[i*2]);
+        right.push_back(in[i*2 + 1]);
+    }
+
+    if ((int)left.size() < taps) {
+        out.clear();
+        return 0;
+    }
+
+    u64 end = (u64)(left.size() - taps + 1) << FRAC_BITS;
+
+    out.resize(((end - std::min(position, end)) / step + 1) * 2);
+
+    int count = 0;
+
+    for (; position < end; position += step, count++) {
+        u64 index = position >> FRAC_BITS;
+        u32 phase = (u32)position >> (FRAC_BITS - PHASE_BITS);
+
+        Taps taps_in;
+
+        taps_in.left   = &left [index];
+        taps_in.right  = &right[index];
+        taps_in.phase0 = &kernel[phase * taps];
+        taps_in.phase1 = &kernel[(phase + 1) * taps];
+        taps_in.frac   = ((u32)position & (((u64)1 << (FRAC_BITS - PHASE_BITS)) - 1)) * (1.0f / ((u64)1 << (FRAC_BITS - PHASE_BITS)));
+
+        float l, r;
+        filter(taps_in, taps, l, r);
+
+        out[count*2]     = to_sample(l);
+        out[count*2 + 1] = to_sample(r);
+    }
+
+    out.resize(count * 2);
+
+    // Drop the frames that every later output has moved past
+    u64 used = position >> FRAC_BITS;
+
+    left .erase(left .begin(), left .begin() + used);
+    right.erase(right.begin(), right.begin() + used);
+
+    position -= used << FRAC_BITS;
+
+    return count;
+}
+
+void Resampler::make_kernel() {
+    const double pi = 3.14159265358979323846;
+
+    // Sharper filters need more taps to keep the ripple down
+    double cutoff;
+
+    switch (quality) {
+        case Quality_Low:
+            taps   = 8;
+            cutoff = 0.70;
+            break;
+
+        case Quality_Medium:
+            taps   = 16;
+            cutoff = 0.85;
+            break;
+
+        case Quality_High:
+        default:
+            taps   = 32;
+            cutoff = 0.92;
+            break;
+    }
+
+    // When going down in rate, the cutoff has to be below the new nyquist frequency
+    if (output_rate < input_rate)
+        cutoff *= output_rate / input_rate;
+
+    kernel.assign((PHASES + 1) * taps, 0.0f);
+
+    for (int phase = 0; phase <= PHASES; phase++) {
+        double impulse[32];
+        double total = 0.0;
+
+        for (int tap = 0; tap < taps; tap++) {
+            double x = tap - (taps/2 - 1) - (double)phase / PHASES;
+
+            double sinc   = (x == 0.0) ? 1.0 : std::sin(pi * x * cutoff) / (pi * x * cutoff);
+            double window = 0.42 + 0.5 * std::cos(2.0 * pi * x / taps) + 0.08 * std::cos(4.0 * pi * x / taps); // Blackman
+
+            impulse[tap] = sinc * window;
+            total += impulse[tap];
+        }
+
+        // Every phase has a gain of one, so that a constant input stays constant
+        for (int tap = 0; tap < taps; tap++)
+            kernel[phase * taps + tap] = impulse[tap] / total;
+    }
+
+    // The history was set up for the old number of taps
+    clear();
+}
+
+void Resampler::update_step() {
+    step = std::llround(input_rate / (output_rate * (1.0 + adjust)) * ((u64)1 << FRAC_BITS));
+}
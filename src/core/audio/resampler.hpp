@@ -0,0 +1,69 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+#include <vector>
+
+// Converts interleaved stereo samples from one rate to another, with a windowed-sinc
+// filter that is stored as a table of phases, one per fraction of an input sample.
+//
+// The ratio can be nudged by a small amount while it is running, so that the output
+// can be kept in step with the audio device.
+//
+// Like any sharp low-pass filter it rings on hard steps, overshooting them by up to
+// about 13% (5% at low quality). The output is saturated, so the input should leave
+// that much headroom, otherwise steps that come close to full scale will clip.
+class Resampler
+{
+public:
+    enum Quality {
+        Quality_Low,    // 8 taps
+        Quality_Medium, // 16 taps
+        Quality_High,   // 32 taps
+    };
+
+    Resampler();
+
+    void set_rates(double input_rate, double output_rate);
+    void set_quality(Quality quality);
+
+    // Makes (1 + adjust) times as many samples, e.g. 0.005 for 0.5% more
+    void set_ratio_adjust(double adjust);
+
+    void clear();
+
+    // Both counts are in stereo frames, out is resized to fit and the number of frames written is returned
+    int process(const s16 *in, int frames, std::vector <s16> &out);
+
+private:
+    void make_kernel();
+    void update_step();
+
+    double input_rate, output_rate;
+    double adjust;
+
+    Quality quality;
+    int taps;
+
+    std::vector <float> kernel; // (PHASES + 1) rows of taps, the last row is for interpolating past the last phase
+
+    u64 position; // In input frames, in fixed point, relative to the start of the history
+    u64 step;
+
+    std::vector <float> left, right; // Input frames that are still needed
+};
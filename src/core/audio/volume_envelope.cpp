@@ -59,7 +59,7 @@ byte VolumeEnvelope::get_nr2() const {
     return (starting_volume << 4) | (add_mode ? BIT3 : 0) | period;
 }
 
-byte VolumeEnvelope::get_volume() {
+byte VolumeEnvelope::get_volume() const {
     if (period > 0)
         return volume;
     else
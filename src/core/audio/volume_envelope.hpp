@@ -31,7 +31,7 @@ public:
     void set_nr2(byte value);
     byte get_nr2() const;
 
-    byte get_volume();
+    byte get_volume() const;
 
     void trigger();
 
@@ -41,3 +41,11 @@ byte Component::read_instruction(word address) {
 byte Component::read_operand(word address) {
     return read(address);
 }
+
+const byte *Component::get_read_page(word address) {
+    return nullptr;
+}
+
+byte *Component::get_write_page(word address) {
+    return nullptr;
+}
@@ -31,6 +31,11 @@ public:
     virtual byte read_instruction(word address);
     virtual byte read_operand    (word address);
 
+    // Returns a pointer to the 256-byte page starting at address if it can be
+    // accessed directly, or nullptr if every access has to go through read/write
+    virtual const byte *get_read_page (word address);
+    virtual byte       *get_write_page(word address);
+
 protected:
     GameBoy *gb;
 };
@@ -0,0 +1,108 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/cpu/block_cache.hpp"
+
+#include <cstdint>
+
+#define NUM_OF_BLOCKS 1024
+
+BlockCache::BlockCache() : blocks(NUM_OF_BLOCKS) {
+    clear();
+}
+
+const BlockCache::Block *BlockCache::get_block(word address, const byte *page) {
+    const byte *start = page + (address & 0xFF);
+
+    Block &block = blocks[(reinterpret_cast<uintptr_t>(start) >> 1) % NUM_OF_BLOCKS];
+
+    if (block.start != start)
+        decode(block, address, page);
+
+    return &block;
+}
+
+void BlockCache::clear() {
+    for (Block &block : blocks) {
+        block.start = nullptr;
+        block.num_of_instrs = 0;
+    }
+}
+
+void BlockCache::decode(Block &block, word address, const byte *page) {
+    block.start = page + (address & 0xFF);
+    block.num_of_instrs = 0;
+
+    int offset = address & 0xFF;
+
+    while (block.num_of_instrs < MaxInstrs) {
+        byte opcode = page[offset];
+        int length  = get_length(opcode);
+
+        // The next page might not follow on from this one (different banks)
+        if (offset + length > 0x100)
+            break;
+
+        Instr &instr = block.instrs[block.num_of_instrs++];
+
+        instr.address = (address & 0xFF00) | offset;
+        instr.opcode  = opcode;
+
+        for (int i = 1; i < length; i++)
+            instr.operands[i-1] = page[offset+i];
+
+        offset += length;
+
+        if (ends_block(opcode) || offset == 0x100)
+            break;
+    }
+}
+
+// Returns the number of bytes the CPU reads for an instruction
+int BlockCache::get_length(byte opcode) {
+    switch (opcode) {
+        case 0x01: case 0x08: case 0x11: case 0x21: case 0x31:
+        case 0xC2: case 0xC3: case 0xC4: case 0xCA: case 0xCC: case 0xCD:
+        case 0xD2: case 0xD4: case 0xDA: case 0xDC:
+        case 0xEA: case 0xFA:
+            return 3;
+
+        case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x36: case 0x3E:
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        case 0xC6: case 0xCE: case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+        case 0xE0: case 0xF0: case 0xE8: case 0xF8:
+        case 0xCB:
+            return 2;
+
+        default:
+            return 1;
+    }
+}
+
+// Does the instruction change the flow of the program
+bool BlockCache::ends_block(byte opcode) {
+    switch (opcode) {
+        case 0x10: case 0x76: case 0xFB: // STOP, HALT, EI
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: // JR
+        case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA: case 0xE9: // JP
+        case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC: // CALL
+        case 0xC0: case 0xC8: case 0xC9: case 0xD0: case 0xD8: case 0xD9: // RET
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF: // RST
+            return true;
+
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+#include <vector>
+
+// Caches pre-decoded basic blocks of ROM code.
+//
+// Blocks are keyed by the host address of their first byte, which is
+// unique for every (bank, address) pair, so a bank switch can never make
+// the CPU run a block from the wrong bank. Only code that is read straight
+// out of the cartridge ROM is cached, since it never changes.
+class BlockCache
+{
+public:
+    static const int MaxInstrs = 32;
+
+    struct Instr {
+        word address;
+        byte opcode;
+        byte operands[2];
+    };
+
+    struct Block {
+        const byte *start; // Host address of the first instruction
+        int num_of_instrs;
+        Instr instrs[MaxInstrs];
+    };
+
+    BlockCache();
+
+    // Returns the block that starts at address, decoding it if it isn't cached yet.
+    // page is the direct page pointer that address lies in.
+    const Block *get_block(word address, const byte *page);
+
+    void clear();
+
+private:
+    void decode(Block &block, word address, const byte *page);
+
+    static int get_length(byte opcode);
+    static bool ends_block(byte opcode);
+
+    std::vector <Block> blocks;
+};
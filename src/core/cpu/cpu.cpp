@@ -15,6 +15,7 @@
 
 #include "core/cpu/cpu.hpp"
 #include "core/gameboy.hpp"
+#include "core/scheduler.hpp"
 #include "core/cpu/timer.hpp"
 #include "core/memory/mmu.hpp"
 #include "core/memory/dma.hpp"
@@ -27,6 +28,7 @@
 #include "common/string_utils.hpp"
 
 #include <fstream>
+#include <algorithm>
 
 Cpu::Cpu(GameBoy *gb) : Component(gb) {
     a = b = c = d = e = f = h = l = 0x00;
@@ -36,6 +38,20 @@ Cpu::Cpu(GameBoy *gb) : Component(gb) {
     IME = 0;
     double_speed = 0;
 
+    cycles = 0;
+    idle_cycles = 0;
+
+#ifdef USE_CPU_TABLE
+    engine = Engine_Table;
+#else
+    engine = Engine_Switch;
+#endif
+
+    block = nullptr;
+    block_pos = 0;
+    block_map = 0;
+    operands = nullptr;
+
     mode = Mode_Normal;
 }
 
@@ -87,13 +103,23 @@ void Cpu::step() {
 
     switch (mode) {
         case Mode_Normal:
-            run_instr(read_instr());
-            interrupt = IME && interrupts_to_do();
+            {
+                word instr_pc = pc;
+
+                execute(fetch_instr());
+                operands = nullptr;
+
+                interrupt = IME && interrupts_to_do();
+
+                // Only a short jump back could be a loop
+                if (!interrupt && pc <= instr_pc && instr_pc - pc < IdleLoop::MaxSize)
+                    check_idle_loop(instr_pc);
+            }
             break;
 
         case Mode_Halt:
         case Mode_Stop:
-            tick4();
+            halt_tick4();
             interrupt = interrupts_to_do();
             break;
 
@@ -101,7 +127,7 @@ void Cpu::step() {
             {
                 byte instr = read_instr();
                 pc--;
-                run_instr(instr);
+                execute(instr);
 
                 mode = Mode_Normal;
                 interrupt = IME && interrupts_to_do();
@@ -109,7 +135,7 @@ void Cpu::step() {
             break;
 
         case Mode_HaltDI:
-            tick4();
+            halt_tick4();
 
             if (interrupts_to_do())
                 mode = Mode_Normal;
@@ -119,7 +145,9 @@ void Cpu::step() {
             IME = 1;
             mode = Mode_Normal;
 
-            run_instr(read_instr());
+            execute(fetch_instr());
+            operands = nullptr;
+
             interrupt = IME && interrupts_to_do();
             break;
     }
@@ -128,54 +156,92 @@ void Cpu::step() {
         execute_interrupt();
 }
 
-void Cpu::tick() {
-    gb->dma   ->tick();
-    gb->timer ->tick();
-    gb->serial->tick();
-    gb->gpu   ->tick();
-    gb->apu   ->tick();
-}
+void Cpu::tick4() {
+    cycles += 4;
 
-void Cpu::tick_double_speed() {
-    gb->dma   ->tick();
-    gb->timer ->tick();
-    gb->serial->tick();
+    gb->scheduler->tick4(double_speed);
 }
 
-void Cpu::tick4() {
-    if (double_speed) {
-        tick();
-        tick_double_speed();
-        tick();
-        tick_double_speed();
+void Cpu::halt_tick4() {
+    // Only an event can wake the CPU up, so skip straight to the next one,
+    // but leave the last cycle so the event still happens on a tick4()
+    int skip = gb->scheduler->cycles_to_event(double_speed) - 1;
+
+    if (skip > 0) {
+        gb->scheduler->skip(skip, double_speed);
+        cycles += skip * 4;
     }
-    else {
-        tick();
-        tick();
-        tick();
-        tick();
+
+    tick4();
+}
+
+void Cpu::check_idle_loop(word branch) {
+    const byte *page = gb->mmu->get_direct_page(pc);
+
+    // Only ROM can be trusted not to change
+    if (pc > 0x7FFF || page == nullptr)
+        return;
+
+    const IdleLoop::Loop *loop = idle_loop.get_loop(pc, page);
+
+    if (!loop->valid || loop->branch != branch)
+        return;
+
+    if (!idle_loop.repeats(loop, a, f, cycles, gb->scheduler->get_event_generation()))
+        return;
+
+    if (((loop->pointers & IdleLoop::Uses_BC) && !IdleLoop::can_poll(bc())) ||
+        ((loop->pointers & IdleLoop::Uses_DE) && !IdleLoop::can_poll(de())) ||
+        ((loop->pointers & IdleLoop::Uses_HL) && !IdleLoop::can_poll(hl())))
+        return;
+
+    int event = gb->scheduler->cycles_to_event(double_speed);
+
+    if (event <= 1)
+        return;
+
+    // Skip every iteration that would be over before the next event
+    int loop_cycles = loop->cycles / 4;
+    int iterations  = (event - 1) / loop_cycles;
+
+    if (iterations > 0) {
+        gb->scheduler->skip(iterations * loop_cycles, double_speed);
+
+        cycles      += iterations * loop->cycles;
+        idle_cycles += iterations * loop->cycles;
+
+        // Carry on from where the skip left off
+        idle_loop.repeats(loop, a, f, cycles, gb->scheduler->get_event_generation());
     }
 }
 
 void Cpu::hdma_tick4() {
-    if (double_speed) {
-        tick();
-        tick_double_speed();
-        tick();
-        tick_double_speed();
+    int bytes_per_cycle = double_speed ? 1 : 2;
 
-        // HDMA takes twice as long in double-speed mode
-        gb->hdma->tick();
+    // Until the next event nothing can see VRAM changing, so copy everything up to it in one go
+    int skip = std::min(gb->scheduler->cycles_to_event(double_speed), gb->hdma->get_bulk_size() / bytes_per_cycle) - 1;
+
+    if (skip > 0) {
+        gb->scheduler->skip(skip, double_speed);
+        gb->hdma->copy_bulk(skip * bytes_per_cycle);
+
+        cycles += skip * 4;
     }
-    else {
-        tick();
-        tick();
-        tick();
-        tick();
 
+    cycles += 4;
+
+    gb->scheduler->tick4(double_speed);
+
+    // HDMA writes to VRAM, so the GPU has to be up to date
+    gb->scheduler->sync();
+
+    // HDMA takes twice as long in double-speed mode
+    gb->hdma->tick();
+
+    if (!double_speed)
         gb->hdma->tick();
-        gb->hdma->tick();
-    }
+
+    gb->scheduler->update();
 }
 
 void Cpu::trigger_interrupt(byte interrupt) {
@@ -225,6 +291,9 @@ void Cpu::load_state(State &state) {
     sp           = state.read16();
     double_speed = state.read8();
     mode         = (Mode)state.read8();
+
+    block = nullptr;
+    idle_loop.reset();
 }
 
 int Cpu::get_reg8(char r) const {
@@ -291,6 +360,22 @@ int Cpu::get_sp() const {
     return sp;
 }
 
+u64 Cpu::get_cycles() const {
+    return cycles;
+}
+
+u64 Cpu::get_idle_cycles() const {
+    return idle_cycles;
+}
+
+void Cpu::set_engine(Engine engine) {
+    this->engine = engine;
+}
+
+Cpu::Engine Cpu::get_engine() const {
+    return engine;
+}
+
 bool Cpu::is_blargg_done() const {
     if (gb->mmu->read_byte(pc+0) == 0x18 && // jp
         gb->mmu->read_byte(pc+1) == 0xFE)   // -2
@@ -352,30 +437,103 @@ inline void Cpu::write_hl(word hl) {
     l = hl & 0xFF;
 }
 
+// Is address owned by a component that is caught up lazily
+inline bool Cpu::is_scheduled(word address) const {
+    return (address >= 0x8000 && address <= 0x9FFF) || (address >= 0xFE00 && address <= 0xFF7F);
+}
+
 inline void Cpu::write_byte(word address, byte value) {
     tick4();
-    gb->mmu->write_byte(address, value);
+
+    // A bulk DMA could be reading from the memory being written
+    if (is_scheduled(address) || gb->dma->is_bulk()) {
+        gb->scheduler->sync();
+        gb->mmu->write_byte(address, value);
+        gb->scheduler->update();
+    }
+
+    else
+        gb->mmu->write_byte(address, value);
 }
 
 inline byte Cpu::read_byte(word address) {
     tick4();
+
+    if (is_scheduled(address))
+        gb->scheduler->sync();
+
     return gb->mmu->read_byte(address);
 }
 
 inline byte Cpu::read_operand() {
     tick4();
+
+    if (operands != nullptr) {
+        pc++;
+        return *operands++;
+    }
+
+    if (is_scheduled(pc))
+        gb->scheduler->sync();
+
     return gb->mmu->read_oper(pc++);
 }
 
 inline byte Cpu::read_instr() {
     tick4();
+
+    if (is_scheduled(pc))
+        gb->scheduler->sync();
+
     byte instr = gb->mmu->read_instr(pc++);
 
     return instr;
 }
 
+// Reads the next instruction out of the block cache, when running from ROM
+inline byte Cpu::fetch_instr() {
+    if (block == nullptr || block_pos >= block->num_of_instrs || block->instrs[block_pos].address != pc ||
+        block_map != gb->mmu->get_map_generation()) {
+        const byte *page = gb->mmu->get_direct_page(pc);
+
+        if (pc > 0x7FFF || page == nullptr) {
+            block = nullptr;
+            return read_instr();
+        }
+
+        block = block_cache.get_block(pc, page);
+        block_pos = 0;
+        block_map = gb->mmu->get_map_generation();
+
+        // The first instruction runs off the end of the page
+        if (!block->num_of_instrs) {
+            block = nullptr;
+            return read_instr();
+        }
+    }
+
+    const BlockCache::Instr &instr = block->instrs[block_pos++];
+
+    tick4();
+
+    pc++;
+    operands = instr.operands;
+
+    return instr.opcode;
+}
+
 void Cpu::skip_operand() {
     tick4();
+
+    if (operands != nullptr) {
+        pc++;
+        operands++;
+        return;
+    }
+
+    if (is_scheduled(pc))
+        gb->scheduler->sync();
+
     gb->mmu->read_oper(pc++);
 }
 
@@ -783,6 +941,48 @@ void Cpu::stop() {
         mode = Mode_Stop;
 }
 
+inline void Cpu::halt() {
+    if (IME)
+        mode = Mode_Halt;
+    else {
+        if (gb->mmu->get_interrupt_enable() & gb->mmu->get_interrupt_flags() & 0x1F)
+            mode = Mode_HaltBug;
+        else
+            mode = Mode_HaltDI;
+    }
+}
+
+inline void Cpu::daa() {
+    byte cf = f & CF;
+    byte hf = f & HF;
+    byte nf = f & NF;
+
+    if (!nf) {
+        if (cf || a > 0x99) {
+            a += 0x60;
+            set_flag(CF);
+        }
+        if (hf || (a & 0x0F) > 0x09)
+            a += 0x6;
+    }
+    else {
+        if (cf)
+            a -= 0x60;
+        if (hf)
+            a -= 0x6;
+    }
+
+    clear_flag(HF);
+    update_flag(ZF, a == 0);
+}
+
+inline void Cpu::execute(byte instr) {
+    if (engine == Engine_Table)
+        (this->*op_table[instr])();
+    else
+        run_instr(instr);
+}
+
 void Cpu::run_instr(byte instr) {
     switch (instr) {
         case 0x00:
@@ -921,29 +1121,7 @@ void Cpu::run_instr(byte instr) {
             h = read_operand();
             break;
         case 0x27:
-            {
-                byte cf = f & CF;
-                byte hf = f & HF;
-                byte nf = f & NF;
-
-                if (!nf) {
-                    if (cf || a > 0x99) {
-                        a += 0x60;
-                        set_flag(CF);
-                    }
-                    if (hf || (a & 0x0F) > 0x09)
-                        a += 0x6;
-                }
-                else {
-                    if (cf)
-                        a -= 0x60;
-                    if (hf)
-                        a -= 0x6;
-                }
-
-                clear_flag(HF);
-                update_flag(ZF, a == 0);
-            }
+            daa();
             break;
         case 0x28:
             if (f & ZF)
@@ -1127,16 +1305,7 @@ void Cpu::run_instr(byte instr) {
         case 0x74: write_byte(hl(), h); break;
         case 0x75: write_byte(hl(), l); break;
 
-        case 0x76:
-            if (IME)
-                mode = Mode_Halt;
-            else {
-                if (gb->mmu->get_interrupt_enable() & gb->mmu->get_interrupt_flags() & 0x1F)
-                    mode = Mode_HaltBug;
-                else
-                    mode = Mode_HaltDI;
-            }
-            break;
+        case 0x76: halt(); break;
 
         case 0x77: write_byte(hl(), a); break;
         case 0x78: a = b; break;
@@ -1795,3 +1964,299 @@ void Cpu::run_instr(byte instr) {
             break;
     }
 }
+
+// The table engine decodes every opcode at compile-time, using the usual
+// x/y/z fields (xxyyyzzz), so each handler only contains the work for its opcode
+
+template <int R>
+inline byte &Cpu::reg() {
+    static_assert(R >= 0 && R <= 7 && R != 6, "Invalid register");
+
+    if      constexpr (R == 0) return b;
+    else if constexpr (R == 1) return c;
+    else if constexpr (R == 2) return d;
+    else if constexpr (R == 3) return e;
+    else if constexpr (R == 4) return h;
+    else if constexpr (R == 5) return l;
+    else                       return a;
+}
+
+template <int R>
+inline byte Cpu::read_r() {
+    if constexpr (R == 6)
+        return read_byte(hl());
+    else
+        return reg<R>();
+}
+
+template <int R>
+inline void Cpu::write_r(byte value) {
+    if constexpr (R == 6)
+        write_byte(hl(), value);
+    else
+        reg<R>() = value;
+}
+
+template <int R, typename Op>
+inline void Cpu::modify_r(Op op) {
+    if constexpr (R == 6) {
+        byte value = read_byte(hl());
+        op(value);
+        write_byte(hl(), value);
+    }
+
+    else
+        op(reg<R>());
+}
+
+template <int C>
+inline bool Cpu::condition() const {
+    if      constexpr (C == 0) return !(f & ZF);
+    else if constexpr (C == 1) return   f & ZF;
+    else if constexpr (C == 2) return !(f & CF);
+    else                       return   f & CF;
+}
+
+template <int Op>
+inline void Cpu::alu(byte n) {
+    if      constexpr (Op == 0) add_a_n(n);
+    else if constexpr (Op == 1) adc_a_n(n);
+    else if constexpr (Op == 2) sub_a_n(n);
+    else if constexpr (Op == 3) sbc_a_n(n);
+    else if constexpr (Op == 4) and_a_n(n);
+    else if constexpr (Op == 5) xor_a_n(n);
+    else if constexpr (Op == 6) or_a_n(n);
+    else                        cp_a_n(n);
+}
+
+template <int Op>
+void Cpu::exec() {
+    constexpr int x = Op >> 6;
+    constexpr int y = (Op >> 3) & 7;
+    constexpr int z = Op & 7;
+    constexpr int p = y >> 1;
+    constexpr int q = y & 1;
+
+    if constexpr (x == 0) {
+        if constexpr (z == 0) {
+            if constexpr (y == 1) { // LD (nn), SP
+                byte low  = read_operand();
+                byte high = read_operand();
+
+                word addr = high << 8 | low;
+
+                write_byte(addr, sp & 0xFF);
+                write_byte(addr+1, sp >> 8);
+            }
+            else if constexpr (y == 2) stop();
+            else if constexpr (y == 3) jr_n();
+            else if constexpr (y >= 4) {
+                if (condition<y-4>())
+                    jr_n();
+                else
+                    skip_operand();
+            }
+        }
+
+        else if constexpr (z == 1) {
+            if constexpr (q == 0) {
+                if constexpr (p == 3) {
+                    byte low  = read_operand();
+                    byte high = read_operand();
+
+                    sp = high << 8 | low;
+                }
+                else
+                    ld_rr_nn(reg<p*2>(), reg<p*2+1>());
+            }
+
+            else {
+                if constexpr (p == 3)
+                    add_hl_rr(sp >> 8, sp & 0xFF);
+                else
+                    add_hl_rr(reg<p*2>(), reg<p*2+1>());
+            }
+        }
+
+        else if constexpr (z == 2) {
+            word addr;
+
+            if      constexpr (p == 0) addr = bc();
+            else if constexpr (p == 1) addr = de();
+            else                       addr = hl();
+
+            if constexpr (q == 0)
+                write_byte(addr, a);
+            else
+                a = read_byte(addr);
+
+            if      constexpr (p == 2) write_hl(addr+1);
+            else if constexpr (p == 3) write_hl(addr-1);
+        }
+
+        else if constexpr (z == 3) {
+            if constexpr (p == 3) {
+                if constexpr (q == 0) sp++;
+                else                  sp--;
+
+                tick4();
+            }
+
+            else if constexpr (q == 0) inc_rr(reg<p*2>(), reg<p*2+1>());
+            else                       dec_rr(reg<p*2>(), reg<p*2+1>());
+        }
+
+        else if constexpr (z == 4) modify_r<y>([this](byte &r) { inc_r(r); });
+        else if constexpr (z == 5) modify_r<y>([this](byte &r) { dec_r(r); });
+        else if constexpr (z == 6) write_r<y>(read_operand());
+
+        else {
+            if      constexpr (y == 0) { rlc_r(a); clear_flag(ZF); }
+            else if constexpr (y == 1) { rrc_r(a); clear_flag(ZF); }
+            else if constexpr (y == 2) { rl_r(a);  clear_flag(ZF); }
+            else if constexpr (y == 3) { rr_r(a);  clear_flag(ZF); }
+            else if constexpr (y == 4) daa();
+            else if constexpr (y == 5) { set_flag(NF | HF); a ^= 0xFF; }
+            else if constexpr (y == 6) { clear_flag(NF | HF); set_flag(CF); }
+            else {
+                clear_flag(NF | HF);
+                update_flag(CF, !(f & CF));
+            }
+        }
+    }
+
+    else if constexpr (x == 1) {
+        if constexpr (Op == 0x76)
+            halt();
+        else
+            write_r<y>(read_r<z>());
+    }
+
+    else if constexpr (x == 2)
+        alu<y>(read_r<z>());
+
+    else {
+        if constexpr (z == 0) {
+            if constexpr (y < 4) {
+                tick4();
+
+                if (condition<y>())
+                    ret();
+            }
+            else if constexpr (y == 4) write_byte(0xFF00 + read_operand(), a);
+            else if constexpr (y == 5) { sp = add_sp_n(); tick4(); }
+            else if constexpr (y == 6) a = read_byte(0xFF00 + read_operand());
+            else                       write_hl(add_sp_n());
+        }
+
+        else if constexpr (z == 1) {
+            if constexpr (q == 0) {
+                if constexpr (p == 3) {
+                    pop_rr(a, f);
+                    f &= 0xF0;
+                }
+                else
+                    pop_rr(reg<p*2>(), reg<p*2+1>());
+            }
+
+            else if constexpr (p == 0) ret();
+            else if constexpr (p == 1) { IME = 1; ret(); }
+            else if constexpr (p == 2) pc = hl();
+            else                       { sp = hl(); tick4(); }
+        }
+
+        else if constexpr (z == 2) {
+            if constexpr (y < 4) {
+                if (condition<y>())
+                    jp_nn();
+                else {
+                    skip_operand();
+                    skip_operand();
+                }
+            }
+            else if constexpr (y == 4) write_byte(0xFF00 + c, a);
+            else if constexpr (y == 6) a = read_byte(0xFF00 + c);
+            else {
+                byte low  = read_operand();
+                byte high = read_operand();
+
+                if constexpr (y == 5)
+                    write_byte(high << 8 | low, a);
+                else
+                    a = read_byte(high << 8 | low);
+            }
+        }
+
+        else if constexpr (z == 3) {
+            if      constexpr (y == 0) jp_nn();
+            else if constexpr (y == 1) (this->*cb_table[read_operand()])();
+            else if constexpr (y == 6) IME = 0;
+            else if constexpr (y == 7) mode = Mode_EnableIME;
+            else                       invalid_op();
+        }
+
+        else if constexpr (z == 4) {
+            if constexpr (y < 4) {
+                if (condition<y>())
+                    call_nn();
+                else {
+                    skip_operand();
+                    skip_operand();
+                }
+            }
+            else
+                invalid_op();
+        }
+
+        else if constexpr (z == 5) {
+            if constexpr (q == 0) {
+                if constexpr (p == 3)
+                    push_rr(a, f);
+                else
+                    push_rr(reg<p*2>(), reg<p*2+1>());
+            }
+            else if constexpr (p == 0)
+                call_nn();
+            else
+                invalid_op();
+        }
+
+        else if constexpr (z == 6) alu<y>(read_operand());
+        else                       rst_n(y * 8);
+    }
+}
+
+template <int Op>
+void Cpu::exec_cb() {
+    constexpr int x = Op >> 6;
+    constexpr int y = (Op >> 3) & 7;
+    constexpr int z = Op & 7;
+
+    if constexpr (x == 0) {
+        if      constexpr (y == 0) modify_r<z>([this](byte &r) { rlc_r(r);  });
+        else if constexpr (y == 1) modify_r<z>([this](byte &r) { rrc_r(r);  });
+        else if constexpr (y == 2) modify_r<z>([this](byte &r) { rl_r(r);   });
+        else if constexpr (y == 3) modify_r<z>([this](byte &r) { rr_r(r);   });
+        else if constexpr (y == 4) modify_r<z>([this](byte &r) { sla_r(r);  });
+        else if constexpr (y == 5) modify_r<z>([this](byte &r) { sra_r(r);  });
+        else if constexpr (y == 6) modify_r<z>([this](byte &r) { swap_r(r); });
+        else                       modify_r<z>([this](byte &r) { srl_r(r);  });
+    }
+
+    else if constexpr (x == 1) bit_n(read_r<z>(), y);
+    else if constexpr (x == 2) modify_r<z>([this](byte &r) { res_r(r, y); });
+    else                       modify_r<z>([this](byte &r) { set_r(r, y); });
+}
+
+template <int... Ops>
+constexpr std::array <Cpu::Handler, 256> Cpu::make_op_table(std::integer_sequence <int, Ops...>) {
+    return {{ &Cpu::exec<Ops>... }};
+}
+
+template <int... Ops>
+constexpr std::array <Cpu::Handler, 256> Cpu::make_cb_table(std::integer_sequence <int, Ops...>) {
+    return {{ &Cpu::exec_cb<Ops>... }};
+}
+
+const std::array <Cpu::Handler, 256> Cpu::op_table = Cpu::make_op_table(std::make_integer_sequence<int, 256>());
+const std::array <Cpu::Handler, 256> Cpu::cb_table = Cpu::make_cb_table(std::make_integer_sequence<int, 256>());
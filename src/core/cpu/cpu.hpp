@@ -16,10 +16,14 @@
 #pragma once
 
 #include "core/component.hpp"
+#include "core/cpu/block_cache.hpp"
+#include "core/cpu/idle_loop.hpp"
 #include "core/defs.hpp"
 #include "core/types.hpp"
 
+#include <array>
 #include <string>
+#include <utility>
 
 // Flags
 #define ZF 0x80
@@ -32,6 +36,12 @@ class State;
 class Cpu : public Component
 {
 public:
+    // The interpreters that can be used to run instructions
+    enum Engine {
+        Engine_Switch, // One big switch statement
+        Engine_Table   // A table of handlers specialized for every opcode
+    };
+
     Cpu(GameBoy *gb);
 
     void init_gb_mode();
@@ -53,15 +63,23 @@ public:
     int get_pc() const;
     int get_sp() const;
 
+    u64 get_cycles() const;
+
+    // Clock cycles that were skipped over in loops waiting for an event
+    u64 get_idle_cycles() const;
+
+    void set_engine(Engine engine);
+    Engine get_engine() const;
+
     bool is_blargg_done () const;
     bool is_mooneye_done() const;
 
 private:
-    void tick();
-    void tick_double_speed();
-
     void tick4();
     void hdma_tick4();
+    void halt_tick4();
+
+    void check_idle_loop(word branch);
 
     // Functions to read the registers when used as byte-pairs
     inline word af() const;
@@ -75,10 +93,13 @@ private:
     inline void write_de(word de);
     inline void write_hl(word hl);
 
+    inline bool is_scheduled(word address) const;
+
     inline void write_byte(word address, byte value);
     inline byte read_byte(word address);
     inline byte read_operand();
     inline byte read_instr();
+    inline byte fetch_instr();
 
     void skip_operand();
 
@@ -139,9 +160,37 @@ private:
     inline word add_sp_n();
 
     void stop();
+    inline void halt();
+    inline void daa();
+
+    inline void execute(byte instr);
 
     void run_instr(byte instr);
 
+    typedef void (Cpu::*Handler)();
+
+    // Register R, where 0-7 are B, C, D, E, H, L, (HL) and A
+    template <int R> inline byte &reg();
+    template <int R> inline byte read_r();
+    template <int R> inline void write_r(byte value);
+    template <int R, typename Op> inline void modify_r(Op op);
+
+    // Condition C, where 0-3 are NZ, Z, NC and C
+    template <int C> inline bool condition() const;
+
+    template <int Op> inline void alu(byte n);
+
+    template <int Op> void exec();
+    template <int Op> void exec_cb();
+
+    template <int... Ops>
+    static constexpr std::array <Handler, 256> make_op_table(std::integer_sequence <int, Ops...>);
+    template <int... Ops>
+    static constexpr std::array <Handler, 256> make_cb_table(std::integer_sequence <int, Ops...>);
+
+    static const std::array <Handler, 256> op_table;
+    static const std::array <Handler, 256> cb_table;
+
     bool IME; // Interrupt Master Enable Flag
 
     byte a, b, c, d, e, f, h, l; // 8-bit Registers
@@ -149,6 +198,19 @@ private:
 
     bool double_speed;
 
+    u64 cycles; // Number of clock cycles run since power-on
+    u64 idle_cycles;
+
+    Engine engine;
+
+    BlockCache block_cache;
+    const BlockCache::Block *block; // The block being run, if any
+    int block_pos; // Index of the next instruction in the block
+    unsigned int block_map; // Memory map generation the block was looked up in
+    const byte *operands; // Operands of the current instruction, when it came from a block
+
+    IdleLoop idle_loop;
+
     enum Mode {
         Mode_Normal,
         Mode_Halt,
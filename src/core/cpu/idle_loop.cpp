@@ -0,0 +1,192 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/cpu/idle_loop.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#define NUM_OF_LOOPS 64
+
+IdleLoop::IdleLoop() : loops(NUM_OF_LOOPS) {
+    for (Loop &loop : loops) {
+        loop.start = nullptr;
+        loop.valid = false;
+    }
+
+    reset();
+}
+
+const IdleLoop::Loop *IdleLoop::get_loop(word address, const byte *page) {
+    const byte *start = page + (address & 0xFF);
+
+    Loop &loop = loops[(reinterpret_cast<uintptr_t>(start) >> 1) % NUM_OF_LOOPS];
+
+    if (loop.start != start)
+        analyze(loop, address, page);
+
+    return &loop;
+}
+
+bool IdleLoop::repeats(const Loop *loop, byte a, byte f, u64 cycles, unsigned int events) {
+    // Exactly one iteration has to have been run since the last time
+    bool same = loop == last_loop && a == last_a && f == last_f &&
+        cycles - last_cycles == (u64)loop->cycles && events == last_events;
+
+    last_loop   = loop;
+    last_a      = a;
+    last_f      = f;
+    last_cycles = cycles;
+    last_events = events;
+
+    return same;
+}
+
+void IdleLoop::reset() {
+    last_loop = nullptr;
+}
+
+bool IdleLoop::can_poll(word address) {
+    switch (address) {
+        case 0xFF00: // Joypad, only changes in between frames
+        case 0xFF0F: // IF
+        case 0xFF41: // STAT
+        case 0xFF44: // LY
+            return true;
+
+        default:
+            // WRAM and HRAM, only the CPU and DMA write to them
+            return (address >= 0xC000 && address <= 0xDFFF) || address >= 0xFF80;
+    }
+}
+
+void IdleLoop::analyze(Loop &loop, word address, const byte *page) {
+    loop.start    = page + (address & 0xFF);
+    loop.cycles   = 0;
+    loop.pointers = 0;
+    loop.valid    = false;
+
+    int offset = address & 0xFF;
+    int end    = std::min(offset + MaxSize, 0x100); // The next page might be another bank
+
+    while (offset < end) {
+        byte opcode = page[offset];
+
+        // The operands have to be on the same page too
+        byte n  = offset+1 < end ? page[offset+1] : 0;
+        word nn = offset+2 < end ? (page[offset+2] << 8 | n) : 0;
+
+        int length, cycles;
+
+        switch (opcode) {
+            // Reads into A
+            case 0xF0: // LDH A, (n)
+                if (offset+1 >= end || !can_poll(0xFF00 | n))
+                    return;
+                length = 2; cycles = 3;
+                break;
+
+            case 0xFA: // LD A, (nn)
+                if (offset+2 >= end || !can_poll(nn))
+                    return;
+                length = 3; cycles = 4;
+                break;
+
+            case 0x0A: loop.pointers |= Uses_BC; length = 1; cycles = 2; break; // LD A, (BC)
+            case 0x1A: loop.pointers |= Uses_DE; length = 1; cycles = 2; break; // LD A, (DE)
+            case 0x7E: loop.pointers |= Uses_HL; length = 1; cycles = 2; break; // LD A, (HL)
+
+            // ALU with (HL)
+            case 0x86: case 0x8E: case 0x96: case 0x9E: case 0xA6: case 0xAE: case 0xB6: case 0xBE:
+                loop.pointers |= Uses_HL;
+                length = 1; cycles = 2;
+                break;
+
+            // ALU with an immediate
+            case 0xC6: case 0xCE: case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+                if (offset+1 >= end)
+                    return;
+                length = 2; cycles = 2;
+                break;
+
+            case 0xCB:
+                if (offset+1 >= end)
+                    return;
+
+                // BIT b, r
+                if (n >= 0x40 && n <= 0x7F) {
+                    if ((n & 7) == 6) {
+                        loop.pointers |= Uses_HL;
+                        cycles = 3;
+                    }
+                    else
+                        cycles = 2;
+                }
+
+                // Rotates, shifts and SWAP on A
+                else if (n < 0x40 && (n & 7) == 7)
+                    cycles = 2;
+
+                else
+                    return;
+
+                length = 2;
+                break;
+
+            // The jump back to the start
+            case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: // JR
+                if (offset+1 >= end || offset + 2 + s8(n) != (address & 0xFF))
+                    return;
+
+                loop.branch = (address & 0xFF00) | offset;
+                loop.cycles = (loop.cycles + 3) * 4;
+                loop.valid  = true;
+                return;
+
+            case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA: // JP
+                if (offset+2 >= end || nn != address)
+                    return;
+
+                loop.branch = (address & 0xFF00) | offset;
+                loop.cycles = (loop.cycles + 4) * 4;
+                loop.valid  = true;
+                return;
+
+            default:
+                // ALU with a register, and LD A, r
+                if ((opcode >= 0x80 && opcode <= 0xBF) || (opcode >= 0x78 && opcode <= 0x7F)) {
+                    length = 1; cycles = 1;
+                    break;
+                }
+
+                switch (opcode) {
+                    case 0x00: // NOP
+                    case 0x07: case 0x0F: case 0x17: case 0x1F: // RLCA, RRCA, RLA, RRA
+                    case 0x27: case 0x2F: case 0x37: case 0x3F: // DAA, CPL, SCF, CCF
+                    case 0x3C: case 0x3D: // INC A, DEC A
+                        length = 1; cycles = 1;
+                        break;
+
+                    default:
+                        return;
+                }
+
+                break;
+        }
+
+        offset += length;
+        loop.cycles += cycles;
+    }
+}
@@ -0,0 +1,75 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+#include <vector>
+
+// Finds short loops that do nothing but poll memory, waiting for it to change.
+//
+// A loop only counts if it reads from memory that nothing but an event can change
+// (LY, STAT, IF, the joypad, or RAM the interrupt handlers write to), and only
+// changes A and the flags. Once it comes back around to the start with the same
+// A and flags, and no event happened in between, every iteration until the next
+// event will be exactly the same, so they can be skipped.
+class IdleLoop
+{
+public:
+    static const int MaxSize = 16; // In bytes
+
+    // Registers that are used as pointers by the loop
+    enum {
+        Uses_BC = 1 << 0,
+        Uses_DE = 1 << 1,
+        Uses_HL = 1 << 2
+    };
+
+    struct Loop {
+        const byte *start; // Host address of the first instruction
+        word branch;       // Address of the jump back to the start
+        int cycles;        // Clock cycles per iteration
+        byte pointers;     // Uses_*, have to be checked with can_poll() before skipping
+        bool valid;
+    };
+
+    IdleLoop();
+
+    // Returns the loop that starts at address, looking at it if it isn't known yet.
+    // page is the direct page pointer that address lies in.
+    const Loop *get_loop(word address, const byte *page);
+
+    // Remembers the state of the CPU every time the loop comes back around,
+    // and returns true if it's the same as the last time
+    bool repeats(const Loop *loop, byte a, byte f, u64 cycles, unsigned int events);
+
+    // Forgets the last time the loop came around
+    void reset();
+
+    // Can the memory at address only change on an event
+    static bool can_poll(word address);
+
+private:
+    void analyze(Loop &loop, word address, const byte *page);
+
+    std::vector <Loop> loops;
+
+    // The last time a loop came back around
+    const Loop *last_loop;
+    byte last_a, last_f;
+    u64 last_cycles;
+    unsigned int last_events;
+};
@@ -16,6 +16,7 @@
 #include "core/cpu/timer.hpp"
 #include "core/defs.hpp"
 #include "core/gameboy.hpp"
+#include "core/scheduler.hpp"
 #include "core/cpu/cpu.hpp"
 #include "core/state.hpp"
 #include "common/logger.hpp"
@@ -134,6 +135,65 @@ void Timer::tick() {
     }
 }
 
+void Timer::advance(int ticks) {
+    while (ticks > 0) {
+        // Overflows and stale edges are done one tick at a time
+        if (overflow || last_bit != (timer_enabled && (div & current_bit))) {
+            tick();
+            ticks--;
+            continue;
+        }
+
+        if (!timer_enabled) {
+            div += ticks;
+            return;
+        }
+
+        // TIMA is incremented every time the bit goes low,
+        // which happens when DIV becomes a multiple of the period
+        unsigned int period  = current_bit << 1;
+        unsigned int phase   = div & (period - 1);
+        unsigned int edges   = (phase + ticks) / period;
+
+        if (tima + edges <= 0xFF) {
+            tima += edges;
+            div  += ticks;
+            last_bit = (div & current_bit) != 0;
+            return;
+        }
+
+        // Skip to right before the edge that overflows
+        unsigned int skip = (period - phase) + (0xFF - tima) * period - 1;
+
+        tima  = 0xFF;
+        div  += skip;
+        ticks -= skip;
+
+        last_bit = (div & current_bit) != 0;
+
+        tick();
+        ticks--;
+    }
+}
+
+int Timer::next_event() const {
+    // The interrupt is fired 3 ticks after TIMA overflows
+    if (overflow)
+        return ticks_since_overflow < 4 ? 4 - ticks_since_overflow : Scheduler::NoEvent;
+
+    // Let the stale edge be handled first
+    if (last_bit != (timer_enabled && (div & current_bit)))
+        return 1;
+
+    if (!timer_enabled)
+        return Scheduler::NoEvent;
+
+    unsigned int period = current_bit << 1;
+    unsigned int phase  = div & (period - 1);
+
+    return (period - phase) + (0xFF - tima) * period + 3;
+}
+
 void Timer::tima_glitch(bool old_enabled, word old_bit) {
     if (!old_enabled)
         return;
@@ -29,6 +29,9 @@ public:
     void write(word address, byte value) override;
 
     void tick();
+    void advance(int ticks);
+
+    int next_event() const;
 
     void save_state(State &state);
     void load_state(State &state);
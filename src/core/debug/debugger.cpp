@@ -128,6 +128,8 @@ bool Debugger::update() {
         return 0;
 
     cpu_debugger.step(gb->cpu);
+    gb->sync(); // So that the watchpoints see the current I/O registers
+
     int address = cpu_debugger.check_pc(gb->cpu);
 
     if (address != -1) {
@@ -194,6 +196,9 @@ int Debugger::disassemble_instr(word address, std::string &instr) {
 }
 
 int Debugger::get_rom_usage(word address) {
+    // Only track the usage from the first time it is asked for
+    gb->rom->set_usage_tracking(true);
+
     return gb->rom->get_rom_usage(address);
 }
 
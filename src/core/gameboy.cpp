@@ -26,12 +26,17 @@
 #include "core/input/joypad.hpp"
 #include "core/serial/serial.hpp"
 #include "core/state.hpp"
+#include "core/scheduler.hpp"
 #include "core/input/input.hpp"
 #include "core/display/display.hpp"
 #include "common/string_utils.hpp"
+#include "common/logger.hpp"
 #include "core/settings.hpp"
 
 GameBoy::GameBoy() {
+    render_thread = false;
+    frame_skip    = 0;
+
     startup();
 }
 
@@ -41,6 +46,8 @@ GameBoy::~GameBoy() {
 
 // Function to load a ROM
 int GameBoy::load_rom(const std::string &path, std::string &error, bool dump_usage) {
+    power_cycle();
+
     int code = rom->load_rom(path, error);
     if (code < 0)
         return code;
@@ -54,6 +61,8 @@ int GameBoy::load_rom(const std::string &path, std::string &error, bool dump_usa
 }
 
 int GameBoy::load_rom_force_mode(const std::string &path, std::string &error, bool gbc_mode, bool dump_usage) {
+    power_cycle();
+
     int code = rom->load_rom(path, error);
     if (code < 0)
         return code;
@@ -70,12 +79,16 @@ void GameBoy::init() {
     run_bios();
 }
 
-void GameBoy::reset() {
-    shutdown();
-    startup();
-
+int GameBoy::reset() {
+    // power_cycle() clears rom_path, so it can't be passed in directly
+    std::string path = rom_path;
     std::string error;
-    load_rom_force_mode(rom_path, error, gbc_mode);
+
+    int code = load_rom_force_mode(path, error, gbc_mode);
+    if (code < 0)
+        LOG_ERROR("Unable to reset: " + error);
+
+    return code;
 }
 
 // Function to run the GameBoy for 1 emulator frame
@@ -133,6 +146,10 @@ void GameBoy::connect_gameboy_link(GameBoy &gb) {
     gb.serial->set_serial_device(serial);
 }
 
+void GameBoy::sync() {
+    scheduler->sync();
+}
+
 const Color *GameBoy::get_screen_buffer() const {
     return gpu->get_screen_buffer();
 }
@@ -222,6 +239,8 @@ bool GameBoy::get_gbc_mode() {
 }
 
 void GameBoy::save_state(State &state) {
+    scheduler->sync();
+
     cpu   ->save_state(state);
     mmu   ->save_state(state);
     dma   ->save_state(state);
@@ -245,28 +264,27 @@ void GameBoy::load_state(State &state) {
     timer ->load_state(state);
     joypad->load_state(state);
     serial->load_state(state);
-}
 
-int GameBoy::save_state(const std::string &path) {
-    State_File state;
+    scheduler->reset();
 
-    if (state.open_write(path) < 0)
-        return -1;
+    gpu->set_render_thread(render_thread);
+    gpu->set_frame_skip(frame_skip);
+}
 
+int GameBoy::save_state(const std::string &path) {
+    State state;
     save_state(state);
-    state.close();
 
-    return 0;
+    return state.save_file(path);
 }
 
 int GameBoy::load_state(const std::string &path) {
-    State_File state;
+    State state;
 
-    if (state.open_read(path) < 0)
+    if (state.load_file(path) < 0)
         return -1;
 
     load_state(state);
-    state.close();
 
     return 0;
 }
@@ -280,24 +298,62 @@ void GameBoy::bind_serial_device(SerialDevice *serial_device) {
 }
 
 void GameBoy::load_settings(Settings &settings) {
+    this->settings = settings;
+
     dmg_bios_path = settings.bios_dmg_path;
     cgb_bios_path = settings.bios_cgb_path;
 
     apu->load_settings(settings);
+
+    set_render_thread(settings.video_render_thread);
+}
+
+void GameBoy::set_render_thread(bool enable) {
+    render_thread = enable;
+    gpu->set_render_thread(enable);
+}
+
+void GameBoy::set_frame_skip(int frames) {
+    frame_skip = frames;
+    gpu->set_frame_skip(frames);
+}
+
+bool GameBoy::is_frame_skipped() const {
+    return gpu->is_frame_skipped();
+}
+
+// Everything that is allocated out of the arena
+std::size_t GameBoy::arena_size() {
+    return MemoryArena::size_of<Scheduler>() +
+           MemoryArena::size_of<Cpu>()       +
+           MemoryArena::size_of<Mmu>()       + Mmu::arena_size() +
+           MemoryArena::size_of<Timer>()     +
+           MemoryArena::size_of<Gpu>()       + Gpu::arena_size() +
+           MemoryArena::size_of<Dma>()       +
+           MemoryArena::size_of<Hdma>()      +
+           MemoryArena::size_of<Apu>()       + Apu::arena_size() +
+           MemoryArena::size_of<Serial>()    +
+           MemoryArena::size_of<Joypad>()    +
+           MemoryArena::size_of<BootRom>()   +
+           MemoryArena::size_of<Rom>();
 }
 
 void GameBoy::startup() {
-    cpu      = new Cpu    (this);
-    mmu      = new Mmu    (this);
-    dma      = new Dma    (this);
-    hdma     = new Hdma   (this);
-    boot_rom = new BootRom(this);
-    rom      = new Rom    (this);
-    gpu      = new Gpu    (this);
-    apu      = new Apu    (this);
-    timer    = new Timer  (this);
-    joypad   = new Joypad (this);
-    serial   = new Serial (this);
+    arena.reset(arena_size());
+
+    // The ones used on every step go first, so that they share cache lines and pages
+    scheduler = arena.create<Scheduler>(this);
+    cpu       = arena.create<Cpu>      (this);
+    mmu       = arena.create<Mmu>      (this);
+    timer     = arena.create<Timer>    (this);
+    gpu       = arena.create<Gpu>      (this);
+    dma       = arena.create<Dma>      (this);
+    hdma      = arena.create<Hdma>     (this);
+    apu       = arena.create<Apu>      (this);
+    serial    = arena.create<Serial>   (this);
+    joypad    = arena.create<Joypad>   (this);
+    boot_rom  = arena.create<BootRom>  (this);
+    rom       = arena.create<Rom>      (this);
 
     mmu->register_component(boot_rom, 0x0000, 0x00FF);
     mmu->register_component(rom,      0x0100, 0x7FFF);
@@ -315,18 +371,40 @@ void GameBoy::startup() {
     mmu->register_component(boot_rom, 0xFF50, 0xFF50);
     mmu->register_component(hdma,     0xFF51, 0xFF55);
     mmu->register_component(gpu,      0xFF68, 0xFF6B);
+
+    scheduler->reset();
+
+    // The new components start out with the defaults
+    gpu->set_render_thread(render_thread);
+    gpu->set_frame_skip(frame_skip);
+
+    apu->load_settings(settings);
+}
+
+// Puts every component back into its power-on state,
+// that way the same GameBoy can be reused for another ROM
+void GameBoy::power_cycle() {
+    if (rom_path.empty())
+        return;
+
+    shutdown();
+    startup();
+
+    rom_path.clear();
 }
 
 void GameBoy::shutdown() {
-    delete cpu;
-    delete mmu;
-    delete dma;
-    delete hdma;
-    delete boot_rom;
-    delete rom;
-    delete gpu;
-    delete apu;
-    delete timer;
-    delete joypad;
-    delete serial;
+    MemoryArena::destroy(cpu);
+    MemoryArena::destroy(mmu);
+    MemoryArena::destroy(dma);
+    MemoryArena::destroy(hdma);
+    MemoryArena::destroy(boot_rom);
+    MemoryArena::destroy(rom);
+    MemoryArena::destroy(gpu);
+    MemoryArena::destroy(apu);
+    MemoryArena::destroy(timer);
+    MemoryArena::destroy(joypad);
+    MemoryArena::destroy(serial);
+
+    MemoryArena::destroy(scheduler);
 }
@@ -16,6 +16,8 @@
 #pragma once
 
 #include "core/types.hpp"
+#include "core/memory/memory_arena.hpp"
+#include "core/settings.hpp"
 #include "common/color.hpp"
 #include <string>
 
@@ -30,6 +32,7 @@ class Apu;
 class Timer;
 class Joypad;
 class Serial;
+class Scheduler;
 class Input;
 class GbcReg;
 
@@ -37,7 +40,6 @@ class Display;
 class AudioDriver;
 class SerialDevice;
 class State;
-class Settings;
 
 class GameBoy
 {
@@ -50,7 +52,8 @@ public:
 
     void init();
 
-    void reset();
+    // Reloads the current ROM into a power-cycled GameBoy, returns -1 on failure
+    int reset();
 
     void run_frame();
 
@@ -62,6 +65,9 @@ public:
 
     bool is_frame_done();
 
+    // Brings every component up to date with the CPU
+    void sync();
+
     void bind_audio_driver(AudioDriver *audio_driver);
     void connect_gameboy_link(GameBoy &gb);
 
@@ -89,6 +95,16 @@ public:
 
     void load_settings(Settings &settings);
 
+    // Draws the screen on a separate thread, that way the emulation thread only has to run the CPU
+    void set_render_thread(bool enable);
+
+    // Only draws 1 out of every (frames+1) frames, for when they can't all be shown anyway.
+    // Skipped frames are still drawn if the screen is asked for, so screenshots come out right.
+    void set_frame_skip(int frames);
+
+    // If the last frame wasn't drawn, and so doesn't need to be shown
+    bool is_frame_skipped() const;
+
     Cpu *cpu;
     Mmu *mmu;
     Dma *dma;
@@ -101,12 +117,21 @@ public:
     Joypad *joypad;
     Serial *serial;
 
+    Scheduler *scheduler;
+
+    // The components, and the memory they own, all live in here
+    MemoryArena arena;
+
     bool gbc_mode;
 
 private:
+    static std::size_t arena_size();
+
     void startup();
     void shutdown();
 
+    void power_cycle();
+
     void run_bios();
 
     std::string rom_path;
@@ -114,5 +139,11 @@ private:
     std::string dmg_bios_path;
     std::string cgb_bios_path;
 
+    bool render_thread;
+    int frame_skip;
+
+    // A copy of the last settings loaded, for the components that are rebuilt on a power cycle
+    Settings settings;
+
     Display *display;
 };
@@ -0,0 +1,102 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/gpu/frame_recorder.hpp"
+
+#include <algorithm>
+
+FrameRecorder::FrameRecorder(const VideoMemory &vram) : vram(vram) {
+}
+
+bool FrameRecorder::is_empty() const {
+    return lines.empty() && writes.empty() && blanks.empty();
+}
+
+void FrameRecorder::write_vram(int bank, word address, byte value) {
+    writes.push_back(Write{(unsigned int)lines.size(), address, (byte)bank, value});
+}
+
+void FrameRecorder::record_line(const LineRecord &line) {
+    lines.push_back(line);
+}
+
+void FrameRecorder::blank() {
+    blanks.push_back(lines.size());
+}
+
+void FrameRecorder::draw(Renderer &renderer, byte *buffer) {
+    // Work backwards to find the lines that made it onto the screen.
+    //
+    // A DMG line with the background off draws on top of what was there before,
+    // and its sprites use the priorities from the line drawn before it,
+    // so those have to be drawn as well.
+    bool on_screen[144];
+    std::fill(on_screen, on_screen + 144, true);
+
+    // Whatever is drawn next might depend on the last line
+    bool needed_next = true;
+
+    visible.assign(lines.size(), false);
+
+    auto blank = blanks.rbegin();
+
+    for (int i = lines.size()-1; i >= 0; i--) {
+        for (; blank != blanks.rend() && *blank > (unsigned int)i; blank++)
+            std::fill(on_screen, on_screen + 144, false);
+
+        const LineRecord &line = lines[i];
+
+        if (!on_screen[line.line] && !needed_next)
+            continue;
+
+        visible[i] = true;
+
+        bool covers_line = line.gbc_mode || line.lcdc.background_on();
+
+        if (covers_line)
+            on_screen[line.line] = false;
+
+        needed_next = !covers_line;
+    }
+
+    // Then replay everything in order
+    auto write = writes.begin();
+    auto next_blank = blanks.begin();
+
+    for (unsigned int i = 0; i <= lines.size(); i++) {
+        for (; write != writes.end() && write->line == i; write++)
+            vram.write(write->bank, write->address, write->value);
+
+        for (; next_blank != blanks.end() && *next_blank == i; next_blank++)
+            std::fill(buffer, buffer + 160*144, Renderer::Palette_Blank << 2);
+
+        if (i < lines.size() && visible[i])
+            renderer.render_line(lines[i], vram, &buffer[lines[i].line * 160]);
+    }
+
+    clear();
+}
+
+void FrameRecorder::sync(const VideoMemory &vram) {
+    clear();
+
+    this->vram = vram;
+}
+
+void FrameRecorder::clear() {
+    lines.clear();
+    writes.clear();
+    blanks.clear();
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+#include "core/gpu/renderer.hpp"
+#include "core/gpu/video_memory.hpp"
+
+#include <vector>
+
+// Keeps the lines and VRAM writes of frames that were skipped, instead of drawing them.
+//
+// Like the render thread, it has its own copy of VRAM, which is VRAM as it was when the
+// screen was last drawn. Drawing replays everything since then, but only the lines that
+// can still be seen, so however many frames were skipped, it costs about one frame.
+class FrameRecorder
+{
+public:
+    FrameRecorder(const VideoMemory &vram);
+
+    bool is_empty() const;
+
+    void write_vram(int bank, word address, byte value);
+    void record_line(const LineRecord &line);
+
+    // Fills the screen with Renderer::Palette_Blank
+    void blank();
+
+    // Brings buffer up to date, the renderer has to be the one the screen was last drawn with
+    void draw(Renderer &renderer, byte *buffer);
+
+    // Replaces the copy of VRAM, after VRAM was changed all at once
+    void sync(const VideoMemory &vram);
+
+private:
+    struct Write {
+        unsigned int line; // The line that it happened before
+        word address;
+        byte bank;
+        byte value;
+    };
+
+    void clear();
+
+    VideoMemory vram;
+
+    std::vector <LineRecord> lines;
+    std::vector <Write> writes;
+    std::vector <unsigned int> blanks; // The line that it happened before
+
+    std::vector <bool> visible;
+};
@@ -14,7 +14,12 @@
 // along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
 
 #include "core/gpu/gpu.hpp"
+#include "core/gpu/screen_convert.hpp"
+#include "core/gpu/render_thread.hpp"
+#include "core/gpu/frame_recorder.hpp"
+#include "core/gpu/video_memory.hpp"
 #include "core/gameboy.hpp"
+#include "core/scheduler.hpp"
 #include "core/cpu/cpu.hpp"
 #include "core/memory/dma.hpp"
 #include "core/memory/hdma.hpp"
@@ -22,15 +27,22 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
+
 Gpu::Gpu(GameBoy *gb) : Component(gb) {
-    screen_buffer = new Color[160*144];
+    index_buffer   = gb->arena.create_array<byte> (160*144);
+    line_palettes  = gb->arena.create_array<Color>(144 * Renderer::Palette_Count*4);
+    screen_buffer  = gb->arena.create_array<Color>(160*144);
+    screen_changed = 0;
     refresh_screen = 0;
 
-    tile_set[0] = new byte[0x1800];
-    tile_set[1] = new byte[0x1800];
+    vram = gb->arena.create<VideoMemory>();
+    render_thread = nullptr;
 
-    background_map = new byte[0x800];
-    tile_attributes = new TileAttribute[0x800];
+    recorder       = nullptr;
+    frame_skip     = 0;
+    frames_skipped = 0;
+    frame_skipped  = 0;
 
     gpu_mode = Mode_HBlank;
 
@@ -50,21 +62,27 @@ Gpu::Gpu(GameBoy *gb) : Component(gb) {
     timer     = 0;
     off_clock = 0;
 
-    std::fill(tile_set[0], tile_set[0] + 0x1800, 0x00);
-    std::fill(tile_set[1], tile_set[1] + 0x1800, 0x00);
-    std::fill(background_map, background_map + 0x800, 0x00);
-
+    std::fill(index_buffer, index_buffer + 160*144, Renderer::Palette_Blank << 2);
+    std::fill(line_palettes, line_palettes + 144 * Renderer::Palette_Count*4, Color{255, 255, 255, 255});
     std::fill(screen_buffer, screen_buffer + 160*144, Color{255, 255, 255, 255});
 }
 
 Gpu::~Gpu() {
-    delete[] screen_buffer;
+    // Stop the thread before the buffer it draws into goes away
+    if (render_thread != nullptr)
+        delete render_thread;
 
-    delete[] tile_set[0];
-    delete[] tile_set[1];
+    if (recorder != nullptr)
+        delete recorder;
 
-    delete[] background_map;
-    delete[] tile_attributes;
+    MemoryArena::destroy(vram);
+}
+
+std::size_t Gpu::arena_size() {
+    return MemoryArena::size_of<byte> (160*144) +
+           MemoryArena::size_of<Color>(144 * Renderer::Palette_Count*4) +
+           MemoryArena::size_of<Color>(160*144) +
+           MemoryArena::size_of<VideoMemory>();
 }
 
 bool Gpu::needs_refresh() const {
@@ -75,18 +93,81 @@ void Gpu::clear_refresh() {
     refresh_screen = 0;
 }
 
-const Color *Gpu::get_screen_buffer() const {
+void Gpu::set_render_thread(bool enable) {
+    // The recorded lines have to be drawn by the renderer that drew the rest
+    if (recorder != nullptr)
+        draw_recorded();
+
+    if (enable && render_thread == nullptr) {
+        render_thread = new RenderThread(index_buffer);
+        render_thread->sync(*vram);
+    }
+
+    else if (!enable && render_thread != nullptr) {
+        delete render_thread;
+        render_thread = nullptr;
+    }
+}
+
+void Gpu::set_frame_skip(int frames) {
+    frames = std::max(frames, 0);
+
+    // Holding down a key keeps setting it
+    if (frames == frame_skip)
+        return;
+
+    if (frames > 0 && recorder == nullptr)
+        recorder = new FrameRecorder(*vram);
+
+    else if (frames == 0 && recorder != nullptr) {
+        draw_recorded();
+
+        delete recorder;
+        recorder = nullptr;
+    }
+
+    frame_skip     = frames;
+    frames_skipped = 0;
+    frame_skipped  = 0;
+}
+
+bool Gpu::is_frame_skipped() const {
+    return frame_skipped;
+}
+
+const Color *Gpu::get_screen_buffer() {
+    if (recorder != nullptr)
+        draw_recorded();
+    else if (render_thread != nullptr)
+        render_thread->flush();
+
+    if (screen_changed) {
+        for (int y = 0; y < 144; y++)
+            convert_indices(&index_buffer[y * 160], &line_palettes[y * Renderer::Palette_Count*4], &screen_buffer[y * 160], 160);
+
+        screen_changed = 0;
+    }
+
     return screen_buffer;
 }
 
+const byte *Gpu::get_index_buffer() {
+    if (recorder != nullptr)
+        draw_recorded();
+    else if (render_thread != nullptr)
+        render_thread->flush();
+
+    return index_buffer;
+}
+
 byte Gpu::read(word address) {
     if (address >= 0x8000 && address <= 0x97FF)
-        return can_get_vram() ? tile_set[vbk][address - 0x8000] : 0xFF;
+        return can_get_vram() ? vram->tile_set[vbk][address - 0x8000] : 0xFF;
 
     else if (address >= 0x9800 && address <= 0x9FFF) {
         if (can_get_vram()) {
-            if (vbk) return tile_attributes[address - 0x9800].read_byte();
-            else     return background_map [address - 0x9800];
+            if (vbk) return vram->tile_attributes[address - 0x9800].read_byte();
+            else     return vram->background_map [address - 0x9800];
         }
 
         else
@@ -154,11 +235,8 @@ void Gpu::write(word address, byte value) {
     }
 
     else if (address >= 0xFE00 && address <= 0xFE9F) {
-        if (can_get_oam() && !gb->dma->is_transfering()) {
-            address -= 0xFE00;
-
-            sprites[address >> 2].write_byte(address, value);
-        }
+        if (can_get_oam() && !gb->dma->is_transfering())
+            write_sprite(address - 0xFE00, value);
 
         return;
     }
@@ -233,20 +311,26 @@ void Gpu::write(word address, byte value) {
 }
 
 void Gpu::write_oam(word address, byte value) {
-    sprites[address >> 2].write_byte(address, value);
+    write_sprite(address, value);
+}
+
+void Gpu::write_oam(word address, const byte *data, int size) {
+    for (int i = 0; i < size; i++)
+        write_sprite(address + i, data[i]);
 }
 
 void Gpu::write_vram(word address, byte value) {
     if (!can_get_vram())
         return;
 
-    if (address <= 0x17FF)
-        tile_set[vbk][address] = value;
+    if (address > 0x1FFF || !vram->write(vbk, address, value))
+        return;
 
-    else if (address <= 0x1FFF) {
-        if (vbk) tile_attributes[address - 0x1800].write_byte(value);
-        else     background_map [address - 0x1800] = value;
-    }
+    if (render_thread != nullptr)
+        render_thread->write_vram(vbk, address, value);
+
+    if (recorder != nullptr)
+        recorder->write_vram(vbk, address, value);
 }
 
 void Gpu::write_lcdc(byte value) {
@@ -260,8 +344,14 @@ void Gpu::write_lcdc(byte value) {
         if (gpu_mode != Mode_VBlank)
             LOG_WARNING("The screen shouldn't turn off while not in VBLANK");
 
-        for (int i = 0; i < (160*144); i++)
-            screen_buffer[i] = Color { 0xFF, 0xFF, 0xFF, 0xFF };
+        if (recorder != nullptr)
+            recorder->blank();
+        else if (render_thread != nullptr)
+            render_thread->blank();
+        else
+            std::fill(index_buffer, index_buffer + 160*144, Renderer::Palette_Blank << 2);
+
+        screen_changed = 1;
 
         set_mode(Mode_HBlank);
 
@@ -274,17 +364,24 @@ void Gpu::write_lcdc(byte value) {
         check_stat_intr();
 
         timer = 0;
+
+        // The sprites could be read before the DMA is done now
+        gb->dma->stop_bulk();
     }
 }
 
 void Gpu::tick() {
+    advance(1);
+}
+
+void Gpu::advance(int ticks) {
     if (!lcdc.lcd_on()) {
-        off_clock++;
+        off_clock += ticks;
 
         // This is so if the Screen is off
         // The emulator isn't stuck in a loop
         // And can't exit
-        if (off_clock >= 70224) {
+        while (off_clock >= 70224) {
             off_clock -= 70224;
             refresh_screen = 1;
         }
@@ -292,79 +389,128 @@ void Gpu::tick() {
         return;
     }
 
-    timer++;
+    while (ticks > 0) {
+        unsigned int length = mode_ticks();
+
+        if (gpu_mode == Mode_HBlank && gb->gbc_mode)
+            gb->hdma->set_hblank();
+
+        // The mode only changes when the timer hits the exact length
+        if (timer >= length) {
+            timer += ticks;
+            return;
+        }
+
+        unsigned int step = std::min<unsigned int>(ticks, length - timer);
+
+        timer += step;
+        ticks -= step;
+
+        if (timer == length)
+            next_mode();
+    }
+}
+
+int Gpu::next_event() const {
+    if (!lcdc.lcd_on())
+        return 70224 - off_clock;
+
+    // HDMA has to see every HBlank tick
+    if (gpu_mode == Mode_HBlank && gb->gbc_mode && gb->hdma->is_waiting())
+        return 1;
+
+    unsigned int length = mode_ticks();
+
+    return timer < length ? length - timer : Scheduler::NoEvent;
+}
+
+void Gpu::next_mode() {
+    timer = 0;
 
     switch (gpu_mode) {
         case Mode_HBlank:
-            if (gb->gbc_mode)
-                gb->hdma->set_hblank();
+            scan_line++;
 
-            if (timer == hblank_ticks()) {
-                timer = 0;
-                scan_line++;
+            check_lyc();
 
-                check_lyc();
+            if (scan_line == 144) {
+                set_mode(Mode_VBlank);
+                check_stat_intr(1);
 
-                if (scan_line == 144) {
-                    set_mode(Mode_VBlank);
-                    check_stat_intr(1);
+                gb->cpu->trigger_interrupt(INT40);
+                refresh_screen = 1;
 
-                    gb->cpu->trigger_interrupt(INT40);
-                    refresh_screen = 1;
-                }
+                if (recorder != nullptr) {
+                    frame_skipped = frames_skipped < frame_skip;
+
+                    if (frame_skipped)
+                        frames_skipped++;
 
-                else {
-                    set_mode(Mode_Oam);
-                    check_stat_intr();
+                    else {
+                        draw_recorded();
+                        frames_skipped = 0;
+                    }
                 }
             }
 
+            else {
+                set_mode(Mode_Oam);
+                check_stat_intr();
+            }
+
             break;
 
         case Mode_VBlank:
-            if (timer == 456) {
-                timer = 0;
-                scan_line++;
+            scan_line++;
 
-                check_lyc();
-                check_stat_intr();
+            check_lyc();
+            check_stat_intr();
 
-                if (scan_line == 154) {
-                    set_mode(Mode_Oam);
-                    scan_line = 0;
-                    window_counter = 0;
+            if (scan_line == 154) {
+                set_mode(Mode_Oam);
+                scan_line = 0;
+                window_counter = 0;
 
-                    check_lyc();
-                    check_stat_intr();
-                }
+                check_lyc();
+                check_stat_intr();
             }
 
             break;
 
         case Mode_Oam:
-            if (timer == 80) {
-                timer = 0;
-                set_mode(Mode_Vram);
-            }
-
+            set_mode(Mode_Vram);
             break;
 
         case Mode_Vram:
-            if (timer == 172) {
-                timer = 0;
-                set_mode(Mode_HBlank);
+            set_mode(Mode_HBlank);
 
-                check_stat_intr();
+            check_stat_intr();
 
-                render_background_scanline();
-                render_window_scanline();
-                render_sprite_scanline();
-            }
+            render_scanline();
 
             break;
     }
 }
 
+unsigned int Gpu::ticks_until_sprites_read() const {
+    // Only VBlank is known to be long enough, the sprites are read again at the end of line 0's mode 3
+    if (!lcdc.lcd_on() || gpu_mode != Mode_VBlank || timer >= 456)
+        return 0;
+
+    return (154 - scan_line) * 456 - timer + 80 + 172;
+}
+
+unsigned int Gpu::mode_ticks() const {
+    switch (gpu_mode) {
+        case Mode_HBlank: return hblank_ticks();
+        case Mode_VBlank: return 456;
+        case Mode_Oam:    return 80;
+        case Mode_Vram:   return 172;
+    }
+
+    return 0;
+}
+
 unsigned int Gpu::hblank_ticks() const {
     switch (scroll_x & 7) {
         case 0:       return 204;
@@ -399,267 +545,109 @@ void Gpu::check_stat_intr(bool vblank_trigger) {
         stat_intr = 0;
 }
 
-void Gpu::render_background_scanline() {
-    Color *buffer = &screen_buffer[scan_line * 160];
-
-    if (lcdc.background_on() || gb->gbc_mode) {
-        word map_offset = lcdc.background_map();
-
-        word Y = scan_line + scroll_y;
-
-        word tile_y = ((Y >> 3) & 31) << 5;
-        Y &= 7;
-
-        word X, tile_map_address, tile_id;
-        byte tile_x, pixel;
-
-        bool background_tile = lcdc.background_tile();
-
-        byte lo, hi;
-        word tile_addr;
-
-        // GBC stuff
-        if (gb->gbc_mode) {
-            // Render the scanline
-            for (int x = 0; x < 160; x++, buffer++) {
-                X = x + scroll_x;
-                tile_x = (X >> 3) & 31;
-                X &= 7;
+void Gpu::save_line_palettes() {
+    Color *palettes = &line_palettes[scan_line * Renderer::Palette_Count*4];
 
-                tile_map_address = map_offset + tile_y + tile_x;
-
-                if (!background_tile)
-                    tile_id = s8(background_map[tile_map_address]) + 256;
-                else
-                    tile_id = background_map[tile_map_address];
-
-                // It is necessary to recalculate the Y position
-                // every pass because Y-Flip may change it.
-                Y = (scan_line + scroll_y) & 7;
-
-                if (tile_attributes[tile_map_address].x_flip())
-                    X = 7 - X;
-                if (tile_attributes[tile_map_address].y_flip())
-                    Y = 7 - Y;
-
-                tile_addr = (tile_id << 4) + (Y << 1);
-                lo = tile_set[tile_attributes[tile_map_address].vbank()][tile_addr+0] << X;
-                hi = tile_set[tile_attributes[tile_map_address].vbank()][tile_addr+1] << X;
-                pixel = (lo >> 7) | ((hi >> 6) & 0b10);
-
-                *buffer = color_palette[tile_attributes[tile_map_address].pal_num()][pixel];
-
-                scan_line_row_priority[x] = tile_attributes[tile_map_address].priority();
-                scan_line_row[x] = pixel;
-            }
+    if (gb->gbc_mode) {
+        for (int i = 0; i < 8; i++) {
+            std::copy(color_palette[i],        color_palette[i] + 4,        &palettes[(Renderer::Palette_Background + i) * 4]);
+            std::copy(color_sprite_palette[i], color_sprite_palette[i] + 4, &palettes[(Renderer::Palette_Sprite + i) * 4]);
         }
+    }
 
-        else {
-            // Render the scanline
-            for (int x = 0; x < 160; x++, buffer++) {
-                X = x + scroll_x;
-                tile_x = (X >> 3) & 31;
-                X &= 7;
-
-                tile_map_address = map_offset + tile_y + tile_x;
-
-                if (!background_tile)
-                    tile_id = s8(background_map[tile_map_address]) + 256;
-                else
-                    tile_id = background_map[tile_map_address];
+    else {
+        for (int i = 0; i < 4; i++) {
+            // With the background off, the line keeps what was there before,
+            // so it needs to keep the colors it was drawn with too
+            if (lcdc.background_on())
+                palettes[Renderer::Palette_Background*4 + i] = dmg_palette[i];
 
-                tile_addr = (tile_id << 4) + (Y << 1);
-                lo = tile_set[0][tile_addr+0] << X;
-                hi = tile_set[0][tile_addr+1] << X;
-                pixel = (lo >> 7) | ((hi >> 6) & 0b10);
+            palettes[Renderer::Palette_Window*4 + i] = dmg_palette[i];
 
-                *buffer = dmg_palette[pixel];
-                scan_line_row[x] = pixel;
-            }
+            palettes[(Renderer::Palette_Sprite + 0)*4 + i] = dmg_sprite_palettes[0][i];
+            palettes[(Renderer::Palette_Sprite + 1)*4 + i] = dmg_sprite_palettes[1][i];
         }
     }
-}
 
-void Gpu::render_window_scanline() {
-    // Check to see if the Window is enabled
-    if (!lcdc.window_on())
-        return;
+    screen_changed = 1;
+}
 
-    // Check if the window is off screen
-    if (window_y > scan_line || window_x > 166)
+void Gpu::draw_recorded() {
+    if (recorder->is_empty())
         return;
 
-    Color *buffer = &screen_buffer[scan_line * 160];
-
-    // Get the Relative Window Position
-    byte win_y = window_counter++;
-
-    // Find where the tile-map is
-    word map_offset = lcdc.window_map();
-
-    // Get the Y coordinate of the tile in 8 pixel size
-    word tile_y = (win_y >> 3) << 5;
-
-    // Get the X position of the window
-    int win_x = window_x - 7;
-
-    byte tile_x;
-    word tile_map_address;
-    word tile;
-    byte pixel;
-    byte X;
-    byte Y = win_y & 7;
-
-    word tile_addr;
-    byte lo, hi;
-
-    // Go through each pixel on the screen
-    for (int x = 0; x < 160; x++, buffer++) {
-        // Make sure the window isn't to the right
-        if (x < win_x)
-            continue;
-
-        if ((x - win_x) < 0)
-            continue;
-
-        // Get the X coordinate of the tile in 8 pixel size
-        tile_x = (x - win_x) >> 3;
-
-        tile_map_address = map_offset + tile_y + tile_x;
-
-        // Get the Tile-ID from the VRAM
-        tile = background_map[tile_map_address];
-
-        // If BG & Window tileset is enabled, then treat the
-        // Tile-ID as signed number plus the offset
-        if (!lcdc.background_tile())
-            tile = 256 + s8(tile);
-
-        // Get X coordinate of the current pixel in the tile
-        X = (x - win_x) & 7;
-
-        if (gb->gbc_mode) {
-            Y = win_y & 7;
+    if (render_thread != nullptr) {
+        render_thread->flush();
+        recorder->draw(render_thread->get_renderer(), index_buffer);
+    }
 
-            if (tile_attributes[tile_map_address].x_flip())
-                X = 7 - X;
-            if (tile_attributes[tile_map_address].y_flip())
-                Y = 7 - Y;
+    else
+        recorder->draw(renderer, index_buffer);
+}
 
-            tile_addr = (tile << 4) + (Y << 1);
-            lo = tile_set[tile_attributes[tile_map_address].vbank()][tile_addr+0] << X;
-            hi = tile_set[tile_attributes[tile_map_address].vbank()][tile_addr+1] << X;
-            pixel = (lo >> 7) | ((hi >> 6) & 0b10);
+void Gpu::render_scanline() {
+    save_line_palettes();
 
-            *buffer = color_palette[tile_attributes[tile_map_address].pal_num()][pixel];
+    LineRecord line;
 
-            scan_line_row_priority[x] = tile_attributes[tile_map_address].priority();
-        }
+    line.line     = scan_line;
+    line.gbc_mode = gb->gbc_mode;
+    line.lcdc     = lcdc;
+    line.scroll_x = scroll_x;
+    line.scroll_y = scroll_y;
 
-        else {
-            tile_addr = (tile << 4) + (Y << 1);
-            lo = tile_set[0][tile_addr+0] << X;
-            hi = tile_set[0][tile_addr+1] << X;
-            pixel = (lo >> 7) | ((hi >> 6) & 0b10);
+    // Check to see if the window is enabled, and on screen
+    line.window      = lcdc.window_on() && window_y <= scan_line && window_x <= 166;
+    line.window_x    = window_x;
+    line.window_line = line.window ? window_counter++ : 0;
 
-            // Draw the pixel to the screen
-            *buffer = dmg_palette[pixel];
-        }
+    select_sprites(line);
 
-        scan_line_row[x] = pixel;
-    }
+    if (recorder != nullptr)
+        recorder->record_line(line);
+    else if (render_thread != nullptr)
+        render_thread->render_line(line);
+    else
+        renderer.render_line(line, *vram, &index_buffer[scan_line * 160]);
 }
 
-void Gpu::render_sprite_scanline() {
+void Gpu::select_sprites(LineRecord &line) {
+    line.sprite_count = 0;
+
     if (!lcdc.sprite_on())
         return;
 
-    Color *buffer;
-    Sprite *s;
-
-    int height = lcdc.sprite_size();
-    byte mask  = (height == 16) ? 0xFE : 0xFF;
-    byte tile_row, color;
-
-    int sprite_count = 0;
+    u64 candidates = sprite_index.get_line(scan_line, lcdc.sprite_size() == 16);
 
-    for (int i = 0; i < 40; i++) {
-        s = &sprites[i];
+    // Goes through them in OAM order, the same as the hardware
+    while (candidates) {
+        const Sprite &s = sprites[__builtin_ctzll(candidates)];
+        candidates &= candidates - 1;
 
-        if ((s->get_y() <= scan_line) && ((s->get_y() + height) > scan_line)) {
-            int j = sprite_count;
+        int j = line.sprite_count;
 
-            if (!gb->gbc_mode) {
-                while (j > 0 && s->get_x() < obj_scanline[j-1]->get_x()) {
-                    obj_scanline[j] = obj_scanline[j-1];
-                    j--;
-                }
+        // The DMG draws the sprites further to the left on top
+        if (!gb->gbc_mode) {
+            while (j > 0 && s.get_x() < line.sprites[j-1].get_x()) {
+                line.sprites[j] = line.sprites[j-1];
+                j--;
             }
-
-            obj_scanline[j] = s;
-
-            if (++sprite_count == 10)
-                break;
         }
-    }
-
-    int pixel_x;
-
-    word tile_addr;
-    byte hi, lo;
-    byte X;
-
-    for (int i = sprite_count-1; i >= 0; i--) {
-        s = obj_scanline[i];
-        buffer = &screen_buffer[scan_line*160 + s->get_x()];
-
-        if (s->y_flip())
-            tile_row = height - 1 - (scan_line - s->get_y());
-        else
-            tile_row = scan_line - s->get_y();
-
-        for (int x = 0; x < 8; x++, buffer++) {
-            pixel_x = s->get_x() + x;
 
-            if (pixel_x < 0 || pixel_x >= 160)
-                continue;
+        line.sprites[j] = s;
 
-            if (gb->gbc_mode) {
-                if (lcdc.background_on()) { // Master priority on CGB
-                    if (scan_line_row_priority[pixel_x] && scan_line_row[pixel_x])
-                        continue;
-
-                    else if (s->priority() && scan_line_row[pixel_x])
-                        continue;
-                }
-            }
-
-            else if (s->priority() && scan_line_row[pixel_x])
-                continue;
-
-            X = s->x_flip() ? (7 - x) : x;
+        if (++line.sprite_count == 10)
+            break;
+    }
+}
 
-            if (gb->gbc_mode) {
-                tile_addr = ((s->get_tile() & mask) << 4) + (tile_row << 1);
-                lo = tile_set[s->color_vram()][tile_addr+0] << X;
-                hi = tile_set[s->color_vram()][tile_addr+1] << X;
-                color = (lo >> 7) | ((hi >> 6) & 0b10);
+void Gpu::write_sprite(word address, byte value) {
+    Sprite &sprite = sprites[address >> 2];
 
-                if (color)
-                    *buffer = color_sprite_palette[s->color_palette()][color];
-            }
+    if ((address & 0b11) == 0)
+        sprite_index.move(address >> 2, sprite.read_byte(0), value);
 
-            else {
-                tile_addr = ((s->get_tile() & mask) << 4) + (tile_row << 1);
-                lo = tile_set[0][tile_addr+0] << X;
-                hi = tile_set[0][tile_addr+1] << X;
-                color = (lo >> 7) | ((hi >> 6) & 0b10);
-
-                if (color)
-                    *buffer = dmg_sprite_palettes[s->dmg_palette()][color];
-            }
-        }
-    }
+    sprite.write_byte(address, value);
 }
 
 inline void Gpu::set_mode(Mode mode) {
@@ -689,8 +677,8 @@ void Gpu::save_state(State &state) {
     for (int i = 0; i < 40; i++)
         sprites[i].save_state(state);
 
-    state.write_data(tile_set[0], 0x1800);
-    state.write_data(background_map, 0x800);
+    state.write_data(vram->tile_set[0], 0x1800);
+    state.write_data(vram->background_map, 0x800);
 
     state.write8(gpu_mode);
 
@@ -709,19 +697,23 @@ void Gpu::save_state(State &state) {
     state.write8(stat_intr);
 
     if (gb->gbc_mode) {
-        for (int i = 0; i < 0x800; i++)
-            tile_attributes[i].save_state(state);
+        // Every attribute is a single byte, so they can all be copied at once
+        static_assert(sizeof(TileAttribute) == 1, "TileAttribute isn't a single byte");
+        state.write_data(vram->tile_attributes, 0x800);
 
         color_palette.save_state(state);
         color_sprite_palette.save_state(state);
 
-        state.write_data(tile_set[1], 0x1800);
+        state.write_data(vram->tile_set[1], 0x1800);
 
         state.write8(vbk);
     }
 }
 
 void Gpu::load_state(State &state) {
+    if (recorder != nullptr)
+        draw_recorded();
+
     lcdc.load_state(state);
 
     dmg_palette.load_state(state);
@@ -731,8 +723,12 @@ void Gpu::load_state(State &state) {
     for (int i = 0; i < 40; i++)
         sprites[i].load_state(state);
 
-    state.read_data(tile_set[0], 0x1800);
-    state.read_data(background_map, 0x800);
+    sprite_index.rebuild(sprites);
+
+    state.read_data(vram->tile_set[0], 0x1800);
+    state.read_data(vram->background_map, 0x800);
+
+    vram->tile_cache.rebuild(0, vram->tile_set[0]);
 
     gpu_mode = (Mode)state.read8();
 
@@ -751,14 +747,20 @@ void Gpu::load_state(State &state) {
     stat_intr  = state.read8();
 
     if (gb->gbc_mode) {
-        for (int i = 0; i < 0x800; i++)
-            tile_attributes[i].load_state(state);
+        state.read_data(vram->tile_attributes, 0x800);
 
         color_palette.load_state(state);
         color_sprite_palette.load_state(state);
 
-        state.read_data(tile_set[1], 0x1800);
+        state.read_data(vram->tile_set[1], 0x1800);
+        vram->tile_cache.rebuild(1, vram->tile_set[1]);
 
         vbk = state.read8();
     }
+
+    if (render_thread != nullptr)
+        render_thread->sync(*vram);
+
+    if (recorder != nullptr)
+        recorder->sync(*vram);
 }
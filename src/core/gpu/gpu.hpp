@@ -21,10 +21,16 @@
 #include "core/gpu/dmg_palette.hpp"
 #include "core/gpu/color_palette.hpp"
 #include "core/gpu/lcdc.hpp"
-#include "core/gpu/tile_attribute.hpp"
 #include "core/gpu/sprite.hpp"
+#include "core/gpu/sprite_index.hpp"
+#include "core/gpu/renderer.hpp"
+
+#include <cstddef>
 
 class State;
+class RenderThread;
+class FrameRecorder;
+struct VideoMemory;
 
 class Gpu : public Component
 {
@@ -32,10 +38,28 @@ public:
     Gpu(GameBoy *gb);
     ~Gpu();
 
+    // What it allocates out of the GameBoy's arena
+    static std::size_t arena_size();
+
     bool needs_refresh() const;
     void clear_refresh();
 
-    const Color *get_screen_buffer() const;
+    // Draws the lines on a separate thread, in parallel with the CPU
+    void set_render_thread(bool enable);
+
+    // Only draws 1 out of every (frames+1) frames, the ones in between are still
+    // emulated, but are only drawn if the screen is asked for
+    void set_frame_skip(int frames);
+
+    // If the last frame wasn't drawn
+    bool is_frame_skipped() const;
+
+    // Turns the screen into colors first, if it changed since the last time
+    const Color *get_screen_buffer();
+
+    // The screen as drawn, a byte per pixel that is the palette times 4 plus the color.
+    // Cheaper than get_screen_buffer() when the colors themselves aren't needed.
+    const byte *get_index_buffer();
 
     byte read(word address) override;
     void write(word address, byte value) override;
@@ -43,9 +67,18 @@ public:
     void write_oam (word address, byte value);
     void write_vram(word address, byte value);
 
+    // Writes a run of bytes, for DMA transfers
+    void write_oam(word address, const byte *data, int size);
+
+    // How long until the sprites are next looked at, or 0 if it isn't known
+    unsigned int ticks_until_sprites_read() const;
+
     void write_lcdc(byte value);
 
     void tick();
+    void advance(int ticks);
+
+    int next_event() const;
 
     void save_state(State &state);
     void load_state(State &state);
@@ -59,13 +92,21 @@ private:
     };
 
     unsigned int hblank_ticks() const;
+    unsigned int mode_ticks() const;
+
+    void next_mode();
 
     void check_lyc();
     void check_stat_intr(bool vblank_trigger=0);
 
-    void render_background_scanline();
-    void render_window_scanline();
-    void render_sprite_scanline();
+    void save_line_palettes();
+
+    void draw_recorded();
+
+    void render_scanline();
+    void select_sprites(LineRecord &line);
+
+    void write_sprite(word address, byte value);
 
     inline void set_mode(Mode mode);
 
@@ -73,13 +114,19 @@ private:
     bool can_get_oam () const;
     bool can_get_color_palettes() const;
 
+    byte  *index_buffer;
+    Color *line_palettes; // Every line keeps the palettes that it was drawn with
     Color *screen_buffer;
+    bool screen_changed;
     bool refresh_screen;
 
-    byte scan_line_row[160];
-    bool scan_line_row_priority[160];
+    Renderer renderer;
+    RenderThread *render_thread; // Only when the lines are drawn on a separate thread
 
-    Sprite *obj_scanline[10];
+    FrameRecorder *recorder; // Only when frames are being skipped
+    int frame_skip;
+    int frames_skipped;
+    bool frame_skipped;
 
     Mode gpu_mode;
 
@@ -98,10 +145,7 @@ private:
 
     byte vbk; // VRAM Bank
 
-    byte *tile_set[2];
-
-    byte *background_map;
-    TileAttribute *tile_attributes;
+    VideoMemory *vram;
 
     Lcdc lcdc;
 
@@ -112,4 +156,5 @@ private:
     ColorPalette color_sprite_palette;
 
     Sprite sprites[40];
+    SpriteIndex sprite_index;
 };
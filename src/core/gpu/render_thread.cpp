@@ -0,0 +1,145 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/gpu/render_thread.hpp"
+
+#include <algorithm>
+
+// Enough for a couple of frames worth of lines, plus the VRAM writes in between
+#define QUEUE_SIZE 8192
+
+RenderThread::RenderThread(byte *index_buffer) : commands(QUEUE_SIZE) {
+    this->index_buffer = index_buffer;
+
+    sleeping = false;
+    quit     = false;
+
+    worker_thread = std::thread(&RenderThread::worker, this);
+}
+
+RenderThread::~RenderThread() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        quit = true;
+    }
+
+    wake.notify_one();
+    worker_thread.join();
+}
+
+void RenderThread::write_vram(int bank, word address, byte value) {
+    Command *command = begin_command();
+
+    command->type    = Command::Type_Write;
+    command->bank    = bank;
+    command->address = address;
+    command->value   = value;
+
+    end_command();
+}
+
+void RenderThread::render_line(const LineRecord &line) {
+    Command *command = begin_command();
+
+    command->type = Command::Type_Line;
+    command->line = line;
+
+    end_command();
+}
+
+void RenderThread::blank() {
+    Command *command = begin_command();
+    command->type = Command::Type_Blank;
+
+    end_command();
+}
+
+void RenderThread::flush() {
+    // It's done once the last command was taken off the queue
+    while (!commands.is_empty())
+        std::this_thread::yield();
+}
+
+void RenderThread::sync(const VideoMemory &vram) {
+    flush();
+
+    this->vram = vram;
+}
+
+Renderer &RenderThread::get_renderer() {
+    return renderer;
+}
+
+RenderThread::Command *RenderThread::begin_command() {
+    Command *command;
+
+    // The queue only fills up if the worker is far behind, so wait for it to catch up
+    while ((command = commands.begin_push()) == nullptr)
+        std::this_thread::yield();
+
+    return command;
+}
+
+void RenderThread::end_command() {
+    commands.end_push();
+
+    // Only bother with the lock if the worker went to sleep,
+    // the fence makes sure it can't fall asleep without seeing the command
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (sleeping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+        }
+
+        wake.notify_one();
+    }
+}
+
+void RenderThread::worker() {
+    while (1) {
+        while (const Command *command = commands.front()) {
+            run(*command);
+            commands.pop();
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        wake.wait(lock, [this] { return quit || !commands.is_empty(); });
+        sleeping.store(false, std::memory_order_relaxed);
+
+        if (quit)
+            break;
+    }
+}
+
+void RenderThread::run(const Command &command) {
+    switch (command.type) {
+        case Command::Type_Write:
+            vram.write(command.bank, command.address, command.value);
+            break;
+
+        case Command::Type_Line:
+            renderer.render_line(command.line, vram, &index_buffer[command.line.line * 160]);
+            break;
+
+        case Command::Type_Blank:
+            std::fill(index_buffer, index_buffer + 160*144, Renderer::Palette_Blank << 2);
+            break;
+    }
+}
@@ -0,0 +1,94 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+#include "core/gpu/renderer.hpp"
+#include "core/gpu/video_memory.hpp"
+#include "common/spsc_queue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Draws lines on a separate thread, while the CPU carries on.
+//
+// The GPU sends it the lines to draw, along with every VRAM write in between,
+// in the same order as they happened. The thread keeps its own copy of VRAM
+// that it replays the writes on, that way every line is drawn with VRAM as it
+// was at the time, and mid-frame effects still come out right.
+class RenderThread
+{
+public:
+    // The lines are drawn into index_buffer
+    RenderThread(byte *index_buffer);
+    ~RenderThread();
+
+    void write_vram(int bank, word address, byte value);
+    void render_line(const LineRecord &line);
+
+    // Fills the screen with Renderer::Palette_Blank
+    void blank();
+
+    // Waits until everything that was sent has been drawn
+    void flush();
+
+    // Replaces the thread's copy of VRAM, after VRAM was changed all at once
+    void sync(const VideoMemory &vram);
+
+    // Only safe to use after flush(), while the thread has nothing to do
+    Renderer &get_renderer();
+
+private:
+    struct Command {
+        enum Type {
+            Type_Write,
+            Type_Line,
+            Type_Blank
+        };
+
+        Type type;
+
+        // Type_Write
+        byte bank;
+        word address;
+        byte value;
+
+        // Type_Line
+        LineRecord line;
+    };
+
+    Command *begin_command();
+    void end_command();
+
+    void worker();
+    void run(const Command &command);
+
+    SpscQueue<Command> commands;
+
+    std::thread worker_thread;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping;
+    bool quit;
+
+    // Only used by the worker, besides in sync()
+    VideoMemory vram;
+    Renderer renderer;
+
+    byte *index_buffer;
+};
@@ -0,0 +1,212 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/gpu/renderer.hpp"
+#include "core/gpu/video_memory.hpp"
+
+#include <algorithm>
+
+void Renderer::render_line(const LineRecord &line, const VideoMemory &vram, byte *buffer) {
+    render_background(line, vram, buffer);
+
+    if (line.window)
+        render_window(line, vram, buffer);
+
+    render_sprites(line, vram, buffer);
+}
+
+void Renderer::render_background(const LineRecord &line, const VideoMemory &vram, byte *buffer) {
+    if (line.lcdc.background_on() || line.gbc_mode) {
+        word map_offset = line.lcdc.background_map();
+
+        word Y = line.line + line.scroll_y;
+
+        word tile_y = ((Y >> 3) & 31) << 5;
+        Y &= 7;
+
+        bool background_tile = line.lcdc.background_tile();
+
+        word X = line.scroll_x;
+        word tile_map_address, tile_id;
+
+        const byte *row;
+        int x = 0;
+
+        // Go a tile at a time, only the first and last tiles can be cut off
+        while (x < 160) {
+            tile_map_address = map_offset + tile_y + ((X >> 3) & 31);
+
+            if (!background_tile)
+                tile_id = s8(vram.background_map[tile_map_address]) + 256;
+            else
+                tile_id = vram.background_map[tile_map_address];
+
+            int start = X & 7;
+            int count = std::min(8 - start, 160 - x);
+
+            // GBC stuff
+            if (line.gbc_mode) {
+                const TileAttribute &attribute = vram.tile_attributes[tile_map_address];
+
+                row = vram.tile_cache.get_row(attribute.vbank(), tile_id, attribute.y_flip() ? (7 - Y) : Y, attribute.x_flip()) + start;
+
+                byte palette  = (Palette_Background + attribute.pal_num()) << 2;
+                bool priority = attribute.priority();
+
+                for (int i = 0; i < count; i++)
+                    buffer[x + i] = palette | row[i];
+
+                std::fill(&scan_line_row_priority[x], &scan_line_row_priority[x + count], priority);
+                std::copy(row, row + count, &scan_line_row[x]);
+            }
+
+            else {
+                row = vram.tile_cache.get_row(0, tile_id, Y, false) + start;
+
+                // The background palette is 0, so the pixels are just the colors
+                std::copy(row, row + count, &buffer[x]);
+                std::copy(row, row + count, &scan_line_row[x]);
+            }
+
+            x += count;
+            X += count;
+        }
+    }
+}
+
+void Renderer::render_window(const LineRecord &line, const VideoMemory &vram, byte *buffer) {
+    // Get the Relative Window Position
+    byte win_y = line.window_line;
+
+    // Find where the tile-map is
+    word map_offset = line.lcdc.window_map();
+
+    // Get the Y coordinate of the tile in 8 pixel size
+    word tile_y = (win_y >> 3) << 5;
+
+    // Get the X position of the window
+    int win_x = line.window_x - 7;
+
+    word tile_map_address;
+    word tile;
+    byte Y = win_y & 7;
+
+    const byte *row;
+
+    // The window starts at its left edge, which can be off screen
+    int x = std::max(win_x, 0);
+
+    while (x < 160) {
+        // Get the X coordinate of the tile in 8 pixel size
+        tile_map_address = map_offset + tile_y + ((x - win_x) >> 3);
+
+        // Get the Tile-ID from the VRAM
+        tile = vram.background_map[tile_map_address];
+
+        // If BG & Window tileset is enabled, then treat the
+        // Tile-ID as signed number plus the offset
+        if (!line.lcdc.background_tile())
+            tile = 256 + s8(tile);
+
+        // Get X coordinate of the current pixel in the tile
+        int start = (x - win_x) & 7;
+        int count = std::min(8 - start, 160 - x);
+
+        if (line.gbc_mode) {
+            const TileAttribute &attribute = vram.tile_attributes[tile_map_address];
+
+            row = vram.tile_cache.get_row(attribute.vbank(), tile, attribute.y_flip() ? (7 - Y) : Y, attribute.x_flip()) + start;
+
+            byte palette  = (Palette_Background + attribute.pal_num()) << 2;
+            bool priority = attribute.priority();
+
+            for (int i = 0; i < count; i++)
+                buffer[x + i] = palette | row[i];
+
+            std::fill(&scan_line_row_priority[x], &scan_line_row_priority[x + count], priority);
+        }
+
+        else {
+            row = vram.tile_cache.get_row(0, tile, Y, false) + start;
+
+            // Draw the pixels to the screen
+            for (int i = 0; i < count; i++)
+                buffer[x + i] = (Palette_Window << 2) | row[i];
+        }
+
+        std::copy(row, row + count, &scan_line_row[x]);
+
+        x += count;
+    }
+}
+
+void Renderer::render_sprites(const LineRecord &line, const VideoMemory &vram, byte *buffer) {
+    if (!line.lcdc.sprite_on())
+        return;
+
+    const Sprite *s;
+    byte *pixels;
+
+    int height = line.lcdc.sprite_size();
+    byte mask  = (height == 16) ? 0xFE : 0xFF;
+    byte tile_row, color;
+
+    int pixel_x;
+
+    const byte *row;
+
+    for (int i = line.sprite_count-1; i >= 0; i--) {
+        s = &line.sprites[i];
+        pixels = buffer + s->get_x();
+
+        if (s->y_flip())
+            tile_row = height - 1 - (line.line - s->get_y());
+        else
+            tile_row = line.line - s->get_y();
+
+        // Tall sprites carry on into the next tile
+        int tile = (s->get_tile() & mask) + (tile_row >> 3);
+        int bank = line.gbc_mode ? s->color_vram() : 0;
+
+        row = vram.tile_cache.get_row(bank, tile, tile_row & 7, s->x_flip());
+
+        byte palette = (Palette_Sprite + (line.gbc_mode ? s->color_palette() : s->dmg_palette())) << 2;
+
+        for (int x = 0; x < 8; x++, pixels++) {
+            pixel_x = s->get_x() + x;
+
+            if (pixel_x < 0 || pixel_x >= 160)
+                continue;
+
+            if (line.gbc_mode) {
+                if (line.lcdc.background_on()) { // Master priority on CGB
+                    if (scan_line_row_priority[pixel_x] && scan_line_row[pixel_x])
+                        continue;
+
+                    else if (s->priority() && scan_line_row[pixel_x])
+                        continue;
+                }
+            }
+
+            else if (s->priority() && scan_line_row[pixel_x])
+                continue;
+
+            color = row[x];
+
+            if (color)
+                *pixels = palette | color;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+#include "core/gpu/lcdc.hpp"
+#include "core/gpu/sprite.hpp"
+
+struct VideoMemory;
+
+// Everything that a line is drawn with, besides VRAM and the palettes
+struct LineRecord {
+    byte line;
+    bool gbc_mode;
+
+    Lcdc lcdc;
+
+    byte scroll_x;
+    byte scroll_y;
+
+    bool window;      // If the window is on this line
+    byte window_x;
+    byte window_line; // The line of the window, which only counts the lines it was on
+
+    // The sprites on the line, in the order they are drawn in
+    byte sprite_count;
+    Sprite sprites[10];
+};
+
+// Draws lines as palette indices, the palette times 4 plus the color
+class Renderer
+{
+public:
+    // Where the palettes of a line are kept
+    enum {
+        Palette_Background = 0,  // The CGB has 8
+        Palette_Window     = 1,  // Only for the DMG, the CGB shares the background palettes
+        Palette_Sprite     = 8,  // The CGB has 8, and the DMG has 2
+        Palette_Blank      = 16, // For when the LCD is off
+        Palette_Count      = 17
+    };
+
+    // Buffer is the line's 160 pixels
+    void render_line(const LineRecord &line, const VideoMemory &vram, byte *buffer);
+
+private:
+    void render_background(const LineRecord &line, const VideoMemory &vram, byte *buffer);
+    void render_window    (const LineRecord &line, const VideoMemory &vram, byte *buffer);
+    void render_sprites   (const LineRecord &line, const VideoMemory &vram, byte *buffer);
+
+    byte scan_line_row[160];
+    bool scan_line_row_priority[160];
+};
@@ -0,0 +1,69 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/gpu/screen_convert.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(Color) == 4, "Color isn't 4 bytes");
+
+namespace {
+
+void convert_indices_scalar(const byte *indices, const Color *colors, Color *out, unsigned int count) {
+    for (unsigned int i = 0; i < count; i++)
+        out[i] = colors[indices[i]];
+}
+
+#ifdef USE_X86_SIMD
+__attribute__((target("avx2")))
+void convert_indices_avx2(const byte *indices, const Color *colors, Color *out, unsigned int count) {
+    const int *table = reinterpret_cast<const int*>(colors);
+    unsigned int i = 0;
+
+    // Looks up 8 colors at once
+    for (; i + 8 <= count; i += 8) {
+        __m128i bytes   = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i));
+        __m256i offsets = _mm256_cvtepu8_epi32(bytes);
+        __m256i pixels  = _mm256_i32gather_epi32(table, offsets, 4);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), pixels);
+    }
+
+    convert_indices_scalar(indices + i, colors, out + i, count - i);
+}
+#endif
+
+typedef void (*ConvertFunc)(const byte *indices, const Color *colors, Color *out, unsigned int count);
+
+ConvertFunc pick_convert() {
+#ifdef USE_X86_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        return convert_indices_avx2;
+#endif
+
+    return convert_indices_scalar;
+}
+
+}
+
+void convert_indices(const byte *indices, const Color *colors, Color *out, unsigned int count) {
+    static const ConvertFunc convert = pick_convert();
+    convert(indices, colors, out, count);
+}
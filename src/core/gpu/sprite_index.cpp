@@ -0,0 +1,53 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/gpu/sprite_index.hpp"
+#include "core/gpu/sprite.hpp"
+
+#include <algorithm>
+
+SpriteIndex::SpriteIndex() {
+    // Every sprite starts off with a Y of 0, which is off screen
+    std::fill(&lines[0][0], &lines[0][0] + 2*144, 0);
+}
+
+void SpriteIndex::move(int sprite, byte old_y, byte new_y) {
+    if (old_y == new_y)
+        return;
+
+    set(sprite, old_y, false);
+    set(sprite, new_y, true);
+}
+
+void SpriteIndex::rebuild(const Sprite *sprites) {
+    std::fill(&lines[0][0], &lines[0][0] + 2*144, 0);
+
+    for (int i = 0; i < 40; i++)
+        set(i, sprites[i].read_byte(0), true);
+}
+
+void SpriteIndex::set(int sprite, byte y, bool on) {
+    u64 bit = u64(1) << sprite;
+
+    for (int tall = 0; tall < 2; tall++) {
+        int top    = std::max(y - 16, 0);
+        int bottom = std::min(y - 16 + (tall ? 16 : 8), 144);
+
+        for (int line = top; line < bottom; line++) {
+            if (on) lines[tall][line] |=  bit;
+            else    lines[tall][line] &= ~bit;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+class Sprite;
+
+// Which sprites are on every line, kept up to date as OAM is written to,
+// that way a line doesn't have to look through all 40 sprites
+class SpriteIndex
+{
+public:
+    SpriteIndex();
+
+    // Y is the raw OAM value
+    void move(int sprite, byte old_y, byte new_y);
+
+    // After all of OAM was changed at once
+    void rebuild(const Sprite *sprites);
+
+    // Bit N is set if sprite N is on the line, for 8x8 or 8x16 sprites
+    inline u64 get_line(int line, bool tall) const {
+        return lines[tall][line];
+    }
+
+private:
+    void set(int sprite, byte y, bool on);
+
+    u64 lines[2][144];
+};
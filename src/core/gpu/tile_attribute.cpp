@@ -15,7 +15,6 @@
 
 #include "core/gpu/tile_attribute.hpp"
 #include "core/defs.hpp"
-#include "core/state.hpp"
 
 TileAttribute::TileAttribute() {
     value = 0;
@@ -48,11 +47,3 @@ bool TileAttribute::y_flip() const {
 bool TileAttribute::priority() const {
     return value & BIT7;
 }
-
-void TileAttribute::save_state(State &state) {
-    state.write8(value);
-}
-
-void TileAttribute::load_state(State &state) {
-    value = state.read8();
-}
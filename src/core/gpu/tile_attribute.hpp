@@ -17,8 +17,6 @@
 
 #include "core/types.hpp"
 
-class State;
-
 class TileAttribute
 {
 public:
@@ -33,9 +31,6 @@ public:
     bool y_flip  () const; // Vertical flip
     bool priority() const; // BG to OAM priority
 
-    void save_state(State &state);
-    void load_state(State &state);
-
 private:
     byte value;
 };
@@ -0,0 +1,47 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/gpu/tile_cache.hpp"
+
+#include <cstring>
+
+TileCache::TileCache() {
+    std::memset(rows, 0, sizeof(rows));
+}
+
+void TileCache::update(int bank, word address, const byte *tile_set) {
+    address &= ~1;
+
+    int tile = address >> 4;
+    int row  = (address >> 1) & 7;
+
+    byte lo = tile_set[address+0];
+    byte hi = tile_set[address+1];
+
+    byte *normal  = rows[bank][0][tile][row];
+    byte *flipped = rows[bank][1][tile][row];
+
+    for (int x = 0; x < 8; x++) {
+        byte pixel = ((lo >> (7 - x)) & 1) | (((hi >> (7 - x)) & 1) << 1);
+
+        normal [x]     = pixel;
+        flipped[7 - x] = pixel;
+    }
+}
+
+void TileCache::rebuild(int bank, const byte *tile_set) {
+    for (word address = 0; address < 0x1800; address += 2)
+        update(bank, address, tile_set);
+}
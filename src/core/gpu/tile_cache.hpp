@@ -0,0 +1,43 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+// Every tile in VRAM, already decoded from 2bpp to one palette index per byte.
+//
+// It is kept up to date as VRAM is written to, so rendering a scanline is just
+// a matter of looking up rows, instead of pulling every pixel out of the bit-planes.
+class TileCache
+{
+public:
+    TileCache();
+
+    // Decodes the row that the byte at address (0x0000-0x17FF) is part of
+    void update(int bank, word address, const byte *tile_set);
+
+    // Decodes the whole bank, after it was changed all at once
+    void rebuild(int bank, const byte *tile_set);
+
+    // Returns the 8 pixels of a row, tile is 0-383
+    inline const byte *get_row(int bank, int tile, int row, bool x_flip) const {
+        return rows[bank][x_flip][tile][row];
+    }
+
+private:
+    // Bank, X-Flip, Tile, Row, Pixel
+    byte rows[2][2][384][8][8];
+};
@@ -0,0 +1,42 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/gpu/video_memory.hpp"
+
+#include <algorithm>
+
+VideoMemory::VideoMemory() {
+    std::fill(tile_set[0], tile_set[0] + 0x1800, 0x00);
+    std::fill(tile_set[1], tile_set[1] + 0x1800, 0x00);
+    std::fill(background_map, background_map + 0x800, 0x00);
+}
+
+bool VideoMemory::write(int bank, word address, byte value) {
+    if (address <= 0x17FF) {
+        if (tile_set[bank][address] == value)
+            return false;
+
+        tile_set[bank][address] = value;
+        tile_cache.update(bank, address, tile_set[bank]);
+    }
+
+    else if (bank)
+        tile_attributes[address - 0x1800].write_byte(value);
+
+    else
+        background_map[address - 0x1800] = value;
+
+    return true;
+}
@@ -0,0 +1,36 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+#include "core/gpu/tile_attribute.hpp"
+#include "core/gpu/tile_cache.hpp"
+
+// The parts of VRAM that the screen is drawn from
+struct VideoMemory
+{
+    VideoMemory();
+
+    // Address is 0x0000-0x1FFF, returns false if nothing changed
+    bool write(int bank, word address, byte value);
+
+    byte tile_set[2][0x1800];
+
+    byte background_map[0x800];
+    TileAttribute tile_attributes[0x800];
+
+    TileCache tile_cache;
+};
@@ -15,17 +15,24 @@
 
 #include "core/memory/dma.hpp"
 #include "core/gameboy.hpp"
+#include "core/scheduler.hpp"
 #include "core/memory/mmu.hpp"
 #include "core/state.hpp"
 #include "core/gpu/gpu.hpp"
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
+
+#define DMA_LENGTH (160*4+4)
+
 Dma::Dma(GameBoy *gb) : Component(gb) {
     enabled    = 0;
     restarting = 0;
+    bulk       = 0;
 
     timer  = 0;
+    copied = 0;
     source = 0;
     value  = 0;
 }
@@ -44,15 +51,90 @@ void Dma::tick() {
         if (current_source > 0xe000)
             current_source &= ~0x2000;
 
-        gb->gpu->write_oam(offset, gb->mmu->read_byte(current_source));
+        if (offset < 160)
+            gb->gpu->write_oam(offset, gb->mmu->read_byte(current_source));
 
-        if (timer > 160*4+4) {
+        if (timer > DMA_LENGTH) {
             enabled = 0;
             timer = 0;
         }
     }
 }
 
+void Dma::advance(int ticks) {
+    if (!enabled)
+        return;
+
+    if (!bulk) {
+        for (int i = 0; i < ticks; i++)
+            tick();
+
+        return;
+    }
+
+    timer += ticks;
+
+    if (timer > 4)
+        restarting = 0;
+
+    catch_up();
+
+    if (timer > DMA_LENGTH) {
+        enabled = 0;
+        bulk    = 0;
+        timer   = 0;
+    }
+}
+
+// Copies everything the DMA would have written by now, all at once
+void Dma::catch_up() {
+    if (timer <= 4)
+        return;
+
+    // The last byte is written 4 times, and might still change
+    int last = std::min((timer - 4) >> 2, 159);
+
+    if (last < copied)
+        return;
+
+    word current_source = source + copied;
+
+    if (current_source >= 0xe000)
+        current_source &= ~0x2000;
+
+    const byte *page = gb->mmu->get_direct_page(current_source);
+
+    // The memory map changed under it
+    if (page == nullptr) {
+        for (int offset = copied; offset <= last; offset++)
+            gb->gpu->write_oam(offset, gb->mmu->read_byte(current_source++));
+    }
+
+    else
+        gb->gpu->write_oam(copied, page + (current_source & 0xFF), last - copied + 1);
+
+    copied = last;
+}
+
+int Dma::next_event() const {
+    if (bulk)
+        return DMA_LENGTH+1 - timer;
+
+    return enabled ? 1 : Scheduler::NoEvent;
+}
+
+bool Dma::is_active() const {
+    return enabled && !bulk;
+}
+
+bool Dma::is_bulk() const {
+    return bulk;
+}
+
+void Dma::stop_bulk() {
+    bulk = 0;
+}
+
 byte Dma::read(word address) {
     if (address == 0xFF46)
         return value;
@@ -67,10 +149,18 @@ void Dma::write(word address, byte value) {
         this->value = value;
 
         source = value << 8;
-        timer = 0;
+        timer  = 0;
+        copied = 0;
 
         restarting = enabled;
         enabled = 1;
+
+        word current_source = source >= 0xe000 ? source & ~0x2000 : source;
+
+        // When nothing else reads the sprites until it's done, and the source is plain memory,
+        // the transfer doesn't have to be run one clock at a time
+        bulk = gb->mmu->get_direct_page(current_source) != nullptr &&
+               gb->gpu->ticks_until_sprites_read() > DMA_LENGTH;
     }
 
     else
@@ -99,4 +189,8 @@ void Dma::load_state(State &state) {
 
     source = state.read16();
     value  = state.read8();
+
+    // Carries on one clock at a time
+    bulk   = 0;
+    copied = 0;
 }
@@ -25,6 +25,19 @@ public:
     Dma(GameBoy *gb);
 
     void tick();
+    void advance(int ticks);
+
+    int next_event() const;
+
+    // If the DMA has to run in lock-step with everything else
+    bool is_active() const;
+
+    // If the DMA is copying straight out of memory, and only catches up when the scheduler syncs.
+    // Anything that could change its source has to sync first.
+    bool is_bulk() const;
+
+    // Carries on one clock at a time, the scheduler has to be synced first
+    void stop_bulk();
 
     byte read(word address) override;
     void write(word address, byte value) override;
@@ -35,8 +48,12 @@ public:
     void load_state(State &state);
 
 private:
+    void catch_up();
+
     bool enabled, restarting;
+    bool bulk;
     int timer;
+    int copied; // Only for bulk transfers
 
     word source;
     byte value;
@@ -22,6 +22,8 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
+
 Hdma::Hdma(GameBoy *gb) : Component(gb) {
     mode = Mode_Gdma;
 
@@ -35,7 +37,27 @@ Hdma::Hdma(GameBoy *gb) : Component(gb) {
 }
 
 void Hdma::tick() {
-    gb->gpu->write_vram(dest++ & 0x1FFF, gb->mmu->read_byte(source++));
+    copy(gb->mmu->read_byte(source++));
+}
+
+int Hdma::get_bulk_size() const {
+    // The HDMA waits on the GPU between every block
+    if (!copying || mode != Mode_Gdma || gb->mmu->get_direct_page(source) == nullptr)
+        return 0;
+
+    // Blocks never cross a page, so stop at the end of the page
+    return std::min(0x100 - (source & 0xFF), (blocks - 1) * 0x10 + (0x10 - (dest & 0xF)));
+}
+
+void Hdma::copy_bulk(int size) {
+    const byte *page = gb->mmu->get_direct_page(source);
+
+    for (int i = 0; i < size; i++)
+        copy(page[source++ & 0xFF]);
+}
+
+void Hdma::copy(byte value) {
+    gb->gpu->write_vram(dest++ & 0x1FFF, value);
 
     // If a block has finished
     if ((dest & 0xF) == 0) {
@@ -155,6 +177,11 @@ void Hdma::load_state(State &state) {
     }
 }
 
+// Is an HDMA transfer waiting for the next HBlank
+bool Hdma::is_waiting() const {
+    return gb->gbc_mode && transfering && mode == Mode_Hdma;
+}
+
 void Hdma::set_hblank() {
     if (gb->gbc_mode && transfering && mode == Mode_Hdma)
         copying = 1;
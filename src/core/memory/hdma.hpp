@@ -27,6 +27,10 @@ public:
     void tick();
     bool is_copying() const;
 
+    // How many bytes of a GDMA can be copied straight out of memory, in one go
+    int get_bulk_size() const;
+    void copy_bulk(int size);
+
     byte read(word address) override;
     void write(word address, byte value) override;
 
@@ -34,8 +38,11 @@ public:
     void load_state(State &state);
 
     void set_hblank();
+    bool is_waiting() const;
 
 private:
+    void copy(byte value);
+
     enum Mode {
         Mode_Gdma = 0,
         Mode_Hdma = 1
@@ -0,0 +1,83 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/memory/memory_arena.hpp"
+#include "common/logger.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+MemoryArena::MemoryArena() {
+    memory = nullptr;
+    length = 0;
+
+    front = back = 0;
+}
+
+MemoryArena::~MemoryArena() {
+    std::free(memory);
+}
+
+void MemoryArena::reset(std::size_t size) {
+    size = aligned(size);
+
+    // The same GameBoy always needs the same amount, so this only allocates the first time
+    if (size != length) {
+        std::free(memory);
+
+        memory = static_cast<byte*>(std::aligned_alloc(Alignment, size));
+        length = size;
+    }
+
+    std::memset(memory, 0, length);
+
+    front = 0;
+    back  = length;
+}
+
+std::size_t MemoryArena::size() const {
+    return length;
+}
+
+std::size_t MemoryArena::used() const {
+    return front + (length - back);
+}
+
+void *MemoryArena::allocate_front(std::size_t size) {
+    size = aligned(size);
+
+    if (front + size > back) {
+        LOG_ERROR("MemoryArena::allocate_front Out of memory");
+        std::abort();
+    }
+
+    void *data = memory + front;
+    front += size;
+
+    return data;
+}
+
+void *MemoryArena::allocate_back(std::size_t size) {
+    size = aligned(size);
+
+    if (front + size > back) {
+        LOG_ERROR("MemoryArena::allocate_back Out of memory");
+        std::abort();
+    }
+
+    back -= size;
+
+    return memory + back;
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// A single block of memory that a GameBoy, and everything it owns, is allocated out of.
+//
+// Objects are packed from the front, that way the state the CPU touches on every step
+// is close together, and arrays (WRAM, VRAM, the screen buffers) are packed from the back.
+// Every allocation starts on its own cache line.
+class MemoryArena
+{
+public:
+    static constexpr std::size_t Alignment = 64;
+
+    MemoryArena();
+    ~MemoryArena();
+
+    // Makes room for size bytes, everything allocated before has to have been destroyed
+    void reset(std::size_t size);
+
+    std::size_t size() const;
+    std::size_t used() const;
+
+    static constexpr std::size_t aligned(std::size_t size) {
+        return (size + Alignment-1) & ~(Alignment-1);
+    }
+
+    // How much room an object or an array takes up in the arena
+    template <class T>
+    static constexpr std::size_t size_of(std::size_t count = 1) {
+        return aligned(sizeof(T) * count);
+    }
+
+    template <class T, class... Args>
+    T *create(Args&&... args) {
+        return new (allocate_front(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    T *create_array(std::size_t count) {
+        T *array = static_cast<T*>(allocate_back(sizeof(T) * count));
+
+        for (std::size_t i = 0; i < count; i++)
+            new (array + i) T;
+
+        return array;
+    }
+
+    // Only runs the destructor, the memory is freed along with the arena
+    template <class T>
+    static void destroy(T *object) {
+        if (object != nullptr)
+            object->~T();
+    }
+
+private:
+    void *allocate_front(std::size_t size);
+    void *allocate_back (std::size_t size);
+
+    byte *memory;
+    std::size_t length;
+
+    std::size_t front, back;
+};
@@ -21,48 +21,109 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
+#include <algorithm>
+
 Mmu::Mmu(GameBoy *gb) : Component(gb) {
     for (int i = 0; i < 8; i++)
-        wram[i] = new byte[0x1000];
+        wram[i] = gb->arena.create_array<byte>(0x1000);
+
+    hram = gb->arena.create_array<byte>(0x0080);
+
+    map_generation = 0;
 
-    hram = new byte[0x0080];
+    // The I/O pages are never accessed directly
+    for (int i = 0; i < 0x100; i++) {
+        read_pages [i] = nullptr;
+        write_pages[i] = nullptr;
+    }
 
     reset();
 
     register_component(this, 0x0000, 0xFFFF);
 
-    gbc_reg = new GbcReg(gb);
+    gbc_reg = gb->arena.create<GbcReg>(gb);
     register_component(gbc_reg, 0xFF6C, 0xFF6C);
     register_component(gbc_reg, 0xFF72, 0xFF77);
 }
 
 Mmu::~Mmu() {
-    for (int i = 0; i < 8; i++)
-        delete[] wram[i];
+    MemoryArena::destroy(gbc_reg);
+}
 
-    delete[] hram;
-    delete gbc_reg;
+std::size_t Mmu::arena_size() {
+    return MemoryArena::size_of<byte>(0x1000) * 8 + MemoryArena::size_of<byte>(0x0080) + MemoryArena::size_of<GbcReg>();
 }
 
 byte Mmu::read_byte(word address) {
-    return components[address]->read(address);
+    const byte *page = read_pages[address >> 8];
+
+    if (page != nullptr)
+        return page[address & 0xFF];
+
+    return get_component(address)->read(address);
 }
 
 void Mmu::write_byte(word address, byte value) {
-    components[address]->write(address, value);
+    byte *page = write_pages[address >> 8];
+
+    if (page != nullptr) {
+        page[address & 0xFF] = value;
+        return;
+    }
+
+    get_component(address)->write(address, value);
+
+    // Writing to the ROM area can switch banks
+    if (address <= 0x7FFF)
+        remap(0x0000, 0x7FFF);
 }
 
 byte Mmu::read_instr(word address) {
-    return components[address]->read_instruction(address);
+    const byte *page = read_pages[address >> 8];
+
+    if (page != nullptr)
+        return page[address & 0xFF];
+
+    return get_component(address)->read_instruction(address);
 }
 
 byte Mmu::read_oper(word address) {
-    return components[address]->read_operand(address);
+    const byte *page = read_pages[address >> 8];
+
+    if (page != nullptr)
+        return page[address & 0xFF];
+
+    return get_component(address)->read_operand(address);
 }
 
 void Mmu::register_component(Component *component, word start_address, word end_address) {
-    for (int i = start_address; i <= end_address; i++)
-        components[i] = component;
+    for (int i = start_address; i <= end_address; i++) {
+        if (i >= 0xFE00)
+            io_components[i - 0xFE00] = component;
+
+        else if ((i & 0xFF) == 0)
+            page_components[i >> 8] = component;
+    }
+
+    remap(start_address, end_address);
+}
+
+void Mmu::remap(word start_address, word end_address) {
+    int end_page = std::min(end_address >> 8, 0xFD);
+
+    map_generation++;
+
+    for (int i = start_address >> 8; i <= end_page; i++) {
+        read_pages [i] = page_components[i]->get_read_page (i << 8);
+        write_pages[i] = page_components[i]->get_write_page(i << 8);
+    }
+}
+
+inline Component *Mmu::get_component(word address) const {
+    if (address >= 0xFE00)
+        return io_components[address - 0xFE00];
+
+    return page_components[address >> 8];
 }
 
 byte Mmu::get_interrupt_enable() const {
@@ -144,6 +205,8 @@ void Mmu::load_state(State &state) {
         state.read_data(wram[0], 0x1000);
         state.read_data(wram[1], 0x1000);
     }
+
+    remap(0xD000, 0xDFFF);
 }
 
 byte Mmu::read(word address) {
@@ -232,8 +295,11 @@ void Mmu::write(word address, byte value) {
         key1 |= value & BIT0;
 
     else if (address == 0xFF70) {
-        if (gb->gbc_mode)
+        if (gb->gbc_mode) {
             wram_bank = value & 0b111; // Only the lower 3 bits are writable
+
+            remap(0xD000, 0xDFFF);
+        }
     }
 
     else if (address >= 0xFF80 && address <= 0xFFFE)
@@ -260,3 +326,26 @@ void Mmu::write(word address, byte value) {
         LOG_WARNING("Mmu::write can't access address 0x" + StringUtils::hex(address));
     }
 }
+
+const byte *Mmu::get_read_page(word address) {
+    return get_write_page(address);
+}
+
+byte *Mmu::get_write_page(word address) {
+    if (address >= 0xC000 && address <= 0xCFFF)
+        return wram[0] + (address - 0xC000);
+
+    else if (address >= 0xD000 && address <= 0xDFFF) {
+        int bank = wram_bank != 0 ? wram_bank : 1; // SVBK can only be set in GBC mode
+
+        return wram[bank] + (address - 0xD000);
+    }
+
+    else if (address >= 0xE000 && address <= 0xEFFF)
+        return wram[0] + (address - 0xE000);
+
+    else if (address >= 0xF000 && address <= 0xFDFF)
+        return wram[1] + (address - 0xF000);
+
+    return nullptr;
+}
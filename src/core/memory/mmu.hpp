@@ -18,6 +18,8 @@
 #include "core/component.hpp"
 #include "core/types.hpp"
 
+#include <cstddef>
+
 class State;
 class GbcReg;
 
@@ -27,6 +29,9 @@ public:
     Mmu(GameBoy *gb);
     ~Mmu();
 
+    // What it allocates out of the GameBoy's arena
+    static std::size_t arena_size();
+
     byte read_byte(word address);
     void write_byte(word address, byte value);
 
@@ -35,6 +40,15 @@ public:
 
     void register_component(Component *component, word start_address, word end_address);
 
+    // Refreshes the direct page pointers of the given range
+    void remap(word start_address, word end_address);
+
+    // Returns the direct page pointer of address, or nullptr if it has none
+    inline const byte *get_direct_page(word address) const { return read_pages[address >> 8]; }
+
+    // Changes every time the memory map does (bank switches, etc)
+    inline unsigned int get_map_generation() const { return map_generation; }
+
     byte get_interrupt_enable() const;
     void set_interrupt_enable(byte value);
 
@@ -50,9 +64,14 @@ public:
     byte read(word address) override;
     void write(word address, byte value) override;
 
+    const byte *get_read_page (word address) override;
+    byte       *get_write_page(word address) override;
+
 private:
     void reset();
 
+    inline Component *get_component(word address) const;
+
     byte *wram[8];
     byte *hram;
 
@@ -61,6 +80,16 @@ private:
     byte interrupt_enable;
     byte interrupt_flags;
 
-    Component *components[0x10000];
+    // Memory is split into 256-byte pages, which either point directly to
+    // the memory behind them, or are nullptr and go through the component.
+    // Everything from 0xFE00 up is I/O and is mapped per address instead.
+    const byte *read_pages [0x100];
+    byte       *write_pages[0x100];
+
+    unsigned int map_generation;
+
+    Component *page_components[0xFE];
+    Component *io_components[0x200];
+
     GbcReg *gbc_reg;
 };
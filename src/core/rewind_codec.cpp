@@ -0,0 +1,309 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/rewind_codec.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+
+unsigned int find_not_equal_scalar(const u8 *data, unsigned int start, unsigned int end, u8 value) {
+    while (start != end && data[start] == value)
+        start++;
+
+    return start;
+}
+
+unsigned int find_repeat_scalar(const u8 *data, unsigned int start, unsigned int end) {
+    while (start != end && data[start] != data[start-1])
+        start++;
+
+    return start;
+}
+
+#ifdef USE_X86_SIMD
+
+#ifdef __SSE2__
+unsigned int find_not_equal_sse2(const u8 *data, unsigned int start, unsigned int end, u8 value) {
+    const __m128i values = _mm_set1_epi8(value);
+
+    for (; start + 16 <= end; start += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + start));
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, values)) ^ 0xFFFF;
+
+        if (mask)
+            return start + __builtin_ctz(mask);
+    }
+
+    return find_not_equal_scalar(data, start, end, value);
+}
+
+unsigned int find_repeat_sse2(const u8 *data, unsigned int start, unsigned int end) {
+    for (; start + 16 <= end; start += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + start));
+        __m128i prev  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + start - 1));
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, prev));
+
+        if (mask)
+            return start + __builtin_ctz(mask);
+    }
+
+    return find_repeat_scalar(data, start, end);
+}
+#endif
+
+__attribute__((target("avx2")))
+unsigned int find_not_equal_avx2(const u8 *data, unsigned int start, unsigned int end, u8 value) {
+    const __m256i values = _mm256_set1_epi8(value);
+
+    for (; start + 32 <= end; start += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + start));
+        unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, values)));
+
+        if (mask)
+            return start + __builtin_ctz(mask);
+    }
+
+    return find_not_equal_scalar(data, start, end, value);
+}
+
+__attribute__((target("avx2")))
+unsigned int find_repeat_avx2(const u8 *data, unsigned int start, unsigned int end) {
+    for (; start + 32 <= end; start += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + start));
+        __m256i prev  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + start - 1));
+        unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, prev));
+
+        if (mask)
+            return start + __builtin_ctz(mask);
+    }
+
+    return find_repeat_scalar(data, start, end);
+}
+
+#endif // USE_X86_SIMD
+
+// Simple enough for the compiler to vectorize by itself
+void subtract(u8 *out, const u8 *a, const u8 *b, unsigned int size) {
+    for (unsigned int i = 0; i < size; i++)
+        out[i] = a[i] - b[i];
+}
+
+void subtract(u8 *out, const u8 *a, u8 b, unsigned int size) {
+    for (unsigned int i = 0; i < size; i++)
+        out[i] = a[i] - b;
+}
+
+// LEB128
+u8 *write_count(u8 *out, unsigned int count) {
+    do {
+        u8 byte = count & 0x7F;
+        count >>= 7;
+
+        if (count != 0)
+            byte |= 0x80;
+
+        *out++ = byte;
+    } while (count != 0);
+
+    return out;
+}
+
+int read_count(const u8 *in, unsigned int in_size, unsigned int &pos, unsigned int &count) {
+    unsigned int shift = 0;
+    count = 0;
+
+    while (pos < in_size && shift < 32) {
+        u8 byte = in[pos++];
+
+        count |= (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return 0;
+
+        shift += 7;
+    }
+
+    return -1;
+}
+
+}
+
+RewindCodec::RewindCodec() {
+    if (set_impl(Impl_Avx2) < 0 && set_impl(Impl_Sse2) < 0)
+        set_impl(Impl_Scalar);
+}
+
+bool RewindCodec::is_supported(Impl impl) {
+    switch (impl) {
+        case Impl_Scalar: return true;
+
+#ifdef USE_X86_SIMD
+#ifdef __SSE2__
+        case Impl_Sse2: return true;
+#endif
+        case Impl_Avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+
+        default: return false;
+    }
+}
+
+const char *RewindCodec::get_impl_name(Impl impl) {
+    switch (impl) {
+        case Impl_Scalar: return "scalar";
+        case Impl_Sse2:   return "sse2";
+        case Impl_Avx2:   return "avx2";
+        default:          return "unknown";
+    }
+}
+
+int RewindCodec::set_impl(Impl impl) {
+    if (!is_supported(impl))
+        return -1;
+
+    this->impl = impl;
+
+    switch (impl) {
+#ifdef USE_X86_SIMD
+#ifdef __SSE2__
+        case Impl_Sse2:
+            find_not_equal = find_not_equal_sse2;
+            find_repeat    = find_repeat_sse2;
+            break;
+#endif
+        case Impl_Avx2:
+            find_not_equal = find_not_equal_avx2;
+            find_repeat    = find_repeat_avx2;
+            break;
+#endif
+
+        default:
+            find_not_equal = find_not_equal_scalar;
+            find_repeat    = find_repeat_scalar;
+            break;
+    }
+
+    return 0;
+}
+
+RewindCodec::Impl RewindCodec::get_impl() const {
+    return impl;
+}
+
+void RewindCodec::compress(const u8 *key, const u8 *state, unsigned int size, std::vector <u8> &out) {
+    out.clear();
+
+    if (size == 0)
+        return;
+
+    // At worst every two bytes become a run with a one byte count
+    if (buffer.size() < size + size / 2 + 8)
+        buffer.resize(size + size / 2 + 8);
+
+    if (diff.size() < size)
+        diff.resize(size);
+
+    u8 *d = diff.data();
+    subtract(d, key, state, size);
+
+    u8 *o = buffer.data();
+
+    u8 last = d[0];
+    *o++ = last;
+
+    unsigned int i = 1;
+
+    while (i < size) {
+        if (d[i] == last) {
+            unsigned int end = find_not_equal(d, i + 1, size, last);
+
+            *o++ = last;
+            o = write_count(o, end - (i + 1));
+
+            if (end == size)
+                break;
+
+            last = d[end];
+            *o++ = last;
+
+            i = end + 1;
+        }
+        else {
+            // Every byte up to the next run is stored as is
+            unsigned int end = find_repeat(d, i + 1, size);
+
+            std::memcpy(o, d + i, end - i);
+            o += end - i;
+
+            last = d[end - 1];
+            i = end;
+        }
+    }
+
+    // Only keep what was used, the buffer is much larger than the typical state
+    out.assign(buffer.data(), o);
+}
+
+int RewindCodec::decompress(const u8 *key, const u8 *in, unsigned int in_size, u8 *out, unsigned int size) {
+    if (size == 0 || in_size == 0)
+        return (size == in_size) ? 0 : -1;
+
+    u8 last = in[0];
+    out[0] = key[0] - last;
+
+    unsigned int o = 1;
+    unsigned int i = 1;
+
+    while (i < in_size) {
+        if (in[i] == last) {
+            unsigned int count;
+
+            i++;
+
+            if (read_count(in, in_size, i, count) < 0 || count >= size - o)
+                return -1;
+
+            // The run also includes the byte that was repeated
+            count++;
+
+            subtract(out + o, key + o, last, count);
+
+            o += count;
+        }
+        else {
+            unsigned int end = find_repeat(in, i + 1, in_size);
+            unsigned int length = end - i;
+
+            if (length > size - o)
+                return -1;
+
+            subtract(out + o, key + o, in + i, length);
+
+            o   += length;
+            last = in[end - 1];
+            i    = end;
+        }
+    }
+
+    return (o == size) ? 0 : -1;
+}
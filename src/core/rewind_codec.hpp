@@ -0,0 +1,66 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+#include <vector>
+
+// Compresses a state as the difference from a key state.
+//
+// The bytes of the key minus the state are stored as is, except for runs,
+// which are stored as the repeated byte twice, followed by a LEB128 count of
+// the bytes left in the run. Most of a state stays the same from frame to frame,
+// so the runs are found with SIMD compares, 16 or 32 bytes at a time.
+class RewindCodec
+{
+public:
+    enum Impl {
+        Impl_Scalar,
+        Impl_Sse2,
+        Impl_Avx2
+    };
+
+    // Picks the fastest implementation that the host supports
+    RewindCodec();
+
+    static bool is_supported(Impl impl);
+    static const char *get_impl_name(Impl impl);
+
+    // Returns -1 if the host doesn't support the implementation
+    int set_impl(Impl impl);
+    Impl get_impl() const;
+
+    // The state and the key must both be size bytes
+    void compress(const u8 *key, const u8 *state, unsigned int size, std::vector <u8> &out);
+
+    // Writes exactly size bytes to out, returns -1 if the compressed data doesn't match the key
+    int decompress(const u8 *key, const u8 *in, unsigned int in_size, u8 *out, unsigned int size);
+
+private:
+    // Both return the end if nothing is found
+    typedef unsigned int (*FindNotEqual)(const u8 *data, unsigned int start, unsigned int end, u8 value);
+    typedef unsigned int (*FindRepeat)  (const u8 *data, unsigned int start, unsigned int end);
+
+    Impl impl;
+
+    FindNotEqual find_not_equal;
+    FindRepeat   find_repeat;
+
+    // Scratch space, kept around between states
+    std::vector <u8> diff;
+    std::vector <u8> buffer;
+};
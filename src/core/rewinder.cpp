@@ -15,259 +15,313 @@
 
 #include "rewinder.hpp"
 #include "gameboy.hpp"
+#include "common/logger.hpp"
 
-#include <iostream>
+#include <algorithm>
 
-// Based off https://binji.github.io/posts/binjgb-rewind/
+#define SNAPSHOT_SLOTS 4
 
-RewindSeries::RewindSeries() {
-    pos = 0;
+u64 RewindSeries::get_last_frame() const {
+    return frames.empty() ? key_frame : frames.back().frame;
 }
 
-bool RewindSeries::is_full() const {
-    return pos == frames_per_key;
-}
+Rewinder::Rewinder() : snapshots(SNAPSHOT_SLOTS) {
+    quit = false;
 
-bool RewindSeries::is_empty() const {
-    return pos == 0 && key_state.is_empty();
-}
+    memory_used = 0;
+    state_size  = 0;
+    next_id     = 1;
 
-void RewindSeries::clear() {
-    key_state.clear();
+    worker_key_id = 0;
+    pop_key_id    = 0;
 
-    for (CompressedState &state : compressed_states)
-        state.clear();
+    frame          = 0;
+    length         = 0;
+    memory_budget  = 0;
+    frames_dropped = 0;
 
-    pos = 0;
+    out_of_frames = 0;
 }
 
-void RewindSeries::push(GameBoy &gb) {
-    if (key_state.is_empty())
-        gb.save_state(key_state);
-
-    else {
-        State_Memory state;
+Rewinder::~Rewinder() {
+    if (worker_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            quit = true;
+        }
 
-        compressed_states[pos].clear();
+        wake.notify_one();
+        worker_thread.join();
+    }
+}
 
-        gb.save_state(state);
-        compress(state);
+void Rewinder::set_length(float seconds) {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    length = seconds * 60;
+}
 
-        pos++;
-    }
+void Rewinder::set_memory_budget(unsigned int megabytes) {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    // Done in size_t, otherwise 4096 MB or more wraps around
+    memory_budget = (std::size_t)megabytes << 20;
 }
 
-void RewindSeries::pop(GameBoy &gb) {
-    if (pos == 0)
-        gb.load_state(key_state);
-    else {
-        pos--;
+void Rewinder::push(GameBoy &gb) {
+    if (!worker_thread.joinable())
+        worker_thread = std::thread(&Rewinder::worker, this);
 
-        State_Memory state;
+    Snapshot *snapshot = snapshots.begin_push();
 
-        decompress(state);
-        gb.load_state(state);
+    // Rather skip a frame than hold up the emulation
+    if (snapshot == nullptr) {
+        frames_dropped++;
+        frame++;
+        return;
     }
-}
 
-unsigned int RewindSeries::get_memory_used() const {
-    unsigned int memory = key_state.size();
+    snapshot->frame = frame++;
+    snapshot->state.clear();
+    gb.save_state(snapshot->state);
 
-    for (const CompressedState &state : compressed_states)
-        memory += state.size();
+    snapshots.end_push();
 
-    return memory;
+    // Taking the lock makes sure the worker can't miss the wake-up
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake.notify_one();
+
+    out_of_frames = 0;
 }
 
-void RewindSeries::compress(State_Memory &state_in) {
-    u8 *prev = &key_state.memory[0];
-    u8 *data = &state_in .memory[0];
-    u8 *end  = data + state_in.size();
+void Rewinder::pop(GameBoy &gb) {
+    flush();
 
-    u8 last = *prev++ - *data++;
-    u8 current;
+    std::lock_guard<std::mutex> lock(history_mutex);
 
-    unsigned int count;
+    if (history.empty()) {
+        out_of_frames = 1;
+        return;
+    }
 
-    compressed_states[pos].push_back(last);
+    RewindSeries &series = history.back();
 
-    while (data != end) {
-        current = *prev++ - *data++;
+    if (series.frames.empty()) {
+        u64 dummy_id = 0;
+        decompress_key(series, pop_codec, state, dummy_id);
 
-        if (current == last) {
-            count = 0;
+        frame = series.key_frame + 1;
+        remove_series();
+    }
 
-            while (data != end) {
-                current = *prev++ - *data++;
+    else {
+        RewindSeries::Frame &last = series.frames.back();
 
-                if (current != last)
-                    break;
+        decompress_key(series, pop_codec, pop_key, pop_key_id);
 
-                count++;
-            }
+        state.clear();
+        u8 *data = state.append(series.size);
 
-            compressed_states[pos].push_back(last);
-            write_count(count);
+        if (pop_codec.decompress(pop_key.get_data(), last.data.data(), last.data.size(), data, series.size) < 0)
+            LOG_ERROR("Unable to decompress rewind state");
 
-            if (data == end)
-                break;
-        }
+        frame = last.frame + 1;
 
-        compressed_states[pos].push_back(current);
-        last = current;
+        series.memory -= last.data.size();
+        memory_used   -= last.data.size();
+        series.frames.pop_back();
     }
+
+    gb.load_state(state);
 }
 
-void RewindSeries::decompress(State_Memory &state_out) {
-    u8 *prev = &key_state.memory[0];
-    u8 *data = &compressed_states[pos][0];
-    u8 *end  = data + compressed_states[pos].size();
+std::size_t Rewinder::get_memory_used() {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    return memory_used + snapshots.capacity() * state_size;
+}
 
-    u8 last = *data++;
-    u8 current;
+unsigned int Rewinder::get_frames_dropped() const {
+    return frames_dropped;
+}
 
-    unsigned int count;
+bool Rewinder::has_frames_left() {
+    return !out_of_frames;
+}
 
-    state_out.memory.push_back(*prev++ - last);
+void Rewinder::clear() {
+    flush();
 
-    while (data != end) {
-        current = *data++;
+    std::lock_guard<std::mutex> lock(history_mutex);
 
-        if (current == last) {
-            count = read_count(&data);
+    history.clear();
+    memory_used = 0;
 
-            for (; count > 0; count--)
-                state_out.memory.push_back(*prev++ - current);
-        }
+    worker_key_id = 0;
+    pop_key_id    = 0;
+
+    frame = 0;
+    out_of_frames = 0;
+}
+
+void Rewinder::worker() {
+    std::unique_lock<std::mutex> lock(wake_mutex);
+
+    while (1) {
+        wake.wait(lock, [this] { return quit || !snapshots.is_empty(); });
 
-        state_out.memory.push_back(*prev++ - current);
+        if (quit)
+            break;
+
+        lock.unlock();
+
+        while (Snapshot *snapshot = snapshots.front()) {
+            {
+                std::lock_guard<std::mutex> history_lock(history_mutex);
+                add(*snapshot);
+            }
+
+            snapshots.pop();
+        }
 
-        last = current;
+        lock.lock();
+        drained.notify_all();
     }
 }
 
-void RewindSeries::write_count(unsigned int count) {
-    u8 byte;
+void Rewinder::flush() {
+    std::unique_lock<std::mutex> lock(wake_mutex);
+    drained.wait(lock, [this] { return snapshots.is_empty(); });
+}
 
-    do {
-        byte = count & 0x7F;
-        count >>= 7;
+void Rewinder::add(const Snapshot &snapshot) {
+    const State &state = snapshot.state;
+    state_size = state.size();
 
-        if (count != 0)
-            byte |= 0x80;
+    if (history.empty()) {
+        start_series(snapshot);
+        return;
+    }
 
-        compressed_states[pos].push_back(byte);
-    } while(count != 0);
-}
+    RewindSeries &series = history.back();
+
+    // A series that was already thinned out (after rewinding far back) isn't added to
+    if (series.level != 0 || series.size != state.size() || snapshot.frame - series.key_frame > max_frames_per_key)
+        start_series(snapshot);
 
-unsigned int RewindSeries::read_count(u8 **data) {
-    unsigned int count = 0;
-    unsigned int shift = 0;
-    u8 byte;
+    else {
+        decompress_key(series, worker_codec, worker_key, worker_key_id);
 
-    u8 *bytes = *data;
+        RewindSeries::Frame current;
+        current.frame = snapshot.frame;
 
-    while (1) {
-        byte = *bytes++;
-        *data += 1;
+        worker_codec.compress(worker_key.get_data(), state.get_data(), state.size(), current.data);
 
-        count |= (byte & 0x7F) << shift;
+        // Once the state has drifted this far from the key, a new key is cheaper
+        if (current.data.size() > series.key.size() / 2)
+            start_series(snapshot);
 
-        if ((byte & 0x80) == 0)
-            break;
+        else {
+            series.memory += current.data.size();
+            memory_used   += current.data.size();
 
-        shift += 7;
+            series.frames.push_back(std::move(current));
+        }
     }
 
-    return count;
+    thin();
+    trim();
 }
 
+void Rewinder::thin() {
+    u64 newest = history.back().get_last_frame();
 
-Rewinder::Rewinder() {
-    rewind_series = nullptr;
+    for (RewindSeries &series : history) {
+        u64 age = newest - series.get_last_frame();
+        unsigned int level = 0;
 
-    num_of_series = 0;
-    pos      = 0;
-    last_pos = 0;
+        // Every level keeps half as many frames, and lasts twice as long as the last
+        while (level < max_level && age >= ((2u << level) - 1) * fine_frames)
+            level++;
 
-    out_of_frames = 0;
-}
+        if (level <= series.level)
+            continue;
 
-Rewinder::~Rewinder() {
-    if (rewind_series != nullptr)
-        delete[] rewind_series;
-}
+        u64 mask = (1u << level) - 1;
 
-void Rewinder::set_length(float seconds) {
-    num_of_series = seconds * 60 / RewindSeries::frames_per_key;
+        auto removed = std::remove_if(series.frames.begin(), series.frames.end(),
+            [mask](const RewindSeries::Frame &frame) { return (frame.frame & mask) != 0; });
 
-    if (rewind_series != nullptr)
-        delete[] rewind_series;
+        for (auto it = removed; it != series.frames.end(); ++it) {
+            series.memory -= it->data.size();
+            memory_used   -= it->data.size();
+        }
 
-    rewind_series = new RewindSeries[num_of_series];
+        series.frames.erase(removed, series.frames.end());
+        series.level = level;
+    }
+}
 
-    pos      = 0;
-    last_pos = 0;
+void Rewinder::trim() {
+    u64 newest = history.back().get_last_frame();
 
-    out_of_frames = 0;
-}
+    // The snapshots waiting to be compressed count against the budget too
+    std::size_t snapshot_memory = snapshots.capacity() * state_size;
+    std::size_t budget = (memory_budget > snapshot_memory) ? memory_budget - snapshot_memory : 0;
 
-void Rewinder::push(GameBoy &gb) {
-    if (rewind_series[pos].is_full()) {
-        if (++pos == num_of_series) // Wrap around
-            pos = 0;
+    // The newest series is always kept
+    while (history.size() > 1) {
+        const RewindSeries &oldest = history.front();
 
-        if (rewind_series[pos].is_full())
-            rewind_series[pos].clear();
-    }
+        bool too_old = length        != 0 && newest - oldest.get_last_frame() >= length;
+        bool too_big = memory_budget != 0 && memory_used > budget;
 
-    rewind_series[pos].push(gb);
-    last_pos = pos;
+        if (!too_old && !too_big)
+            break;
 
-    out_of_frames = 0;
+        memory_used -= oldest.memory;
+        history.pop_front();
+    }
 }
 
-void Rewinder::pop(GameBoy &gb) {
-    // Don't wind back too far
-    if (pos == last_pos+1) {
-        out_of_frames = 1;
-        return;
-    }
+void Rewinder::start_series(const Snapshot &snapshot) {
+    const State &state = snapshot.state;
 
-    if (rewind_series[pos].is_empty()) {
-        if (pos == 0) { // Wrap-Around
-            pos = num_of_series-1;
-        }
-        else
-            pos--;
+    if (zeros.size() < state.size())
+        zeros.resize(state.size(), 0);
 
-        // Don't wind back to uninitialized states
-        if (rewind_series[num_of_series-1].is_empty())
-            return;
-    }
+    RewindSeries series;
 
-    rewind_series[pos].pop(gb);
-}
+    series.id        = next_id++;
+    series.key_frame = snapshot.frame;
+    series.size      = state.size();
+    series.level     = 0;
 
-unsigned int Rewinder::get_memory_used() const {
-    unsigned int memory = 0;
+    worker_codec.compress(zeros.data(), state.get_data(), state.size(), series.key);
+    series.memory = series.key.size();
 
-    for (unsigned int i = 0; i < num_of_series; i++)
-        memory += rewind_series[i].get_memory_used();
+    memory_used += series.memory;
+    history.push_back(std::move(series));
 
-    return memory;
+    // The next frames are most likely going to use it
+    worker_key.clear();
+    worker_key.write_data(state.get_data(), state.size());
+    worker_key_id = history.back().id;
 }
 
-bool Rewinder::has_frames_left() {
-    return !out_of_frames;
+void Rewinder::remove_series() {
+    memory_used -= history.back().memory;
+    history.pop_back();
 }
 
-void Rewinder::clear() {
-    for (unsigned int i = 0; i < num_of_series; i++)
-        rewind_series[i].clear();
+void Rewinder::decompress_key(const RewindSeries &series, RewindCodec &codec, State &key, u64 &key_id) {
+    if (key_id == series.id)
+        return;
 
-    pos = 0;
-    last_pos = 0;
+    key.clear();
+    u8 *data = key.append(series.size);
 
-    out_of_frames = 0;
+    if (codec.decompress(zeros.data(), series.key.data(), series.key.size(), data, series.size) < 0)
+        LOG_ERROR("Unable to decompress rewind key state");
+
+    key_id = series.id;
 }
@@ -15,45 +15,49 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "types.hpp"
 #include "state.hpp"
+#include "rewind_codec.hpp"
+#include "common/spsc_queue.hpp"
 
 class GameBoy;
 
 typedef std::vector <u8> CompressedState;
 
-class RewindSeries {
-public:
-    RewindSeries();
+// A key state, followed by the frames after it, stored as the difference from the key
+struct RewindSeries {
+    struct Frame {
+        u64 frame;
+        CompressedState data;
+    };
 
-    bool is_full() const;
-    bool is_empty() const;
+    u64 id;
+    u64 key_frame;
+    unsigned int size;   // Of every state in the series
+    CompressedState key; // Compressed against zeros, which is just RLE
 
-    void clear();
+    std::vector <Frame> frames;
 
-    void push(GameBoy &gb);
-    void pop (GameBoy &gb);
+    unsigned int level;  // Only every (1 << level)th frame is left
+    unsigned int memory;
 
-    unsigned int get_memory_used() const;
-
-    static const unsigned int frames_per_key = 255; // TODO: Find a good value for this
-
-private:
-    void compress  (State_Memory &state_in);
-    void decompress(State_Memory &state_out);
-
-    // LEB128
-    void write_count(unsigned int count);
-    unsigned int read_count(u8 **data);
-
-    State_Memory key_state;
-
-    CompressedState compressed_states[frames_per_key];
-    unsigned int pos;
+    u64 get_last_frame() const;
 };
 
+// Based off https://binji.github.io/posts/binjgb-rewind/
+//
+// The emulation thread only takes a raw snapshot every frame, and hands it
+// to a worker thread through a lock-free queue, which does the compressing.
+// The frames thin out as they get older, so that recent history can be
+// rewound frame by frame, and older history is coarser but reaches further
+// back. The oldest series are thrown away to stay within the memory budget.
 class Rewinder
 {
 public:
@@ -61,20 +65,75 @@ public:
     ~Rewinder();
 
     void set_length(float seconds);
+    void set_memory_budget(unsigned int megabytes);
 
     void push(GameBoy &gb);
     void pop (GameBoy &gb);
 
-    unsigned int get_memory_used() const;
+    // Includes the snapshots waiting to be compressed
+    std::size_t get_memory_used();
+
+    // Frames that couldn't be saved, because the worker thread fell behind
+    unsigned int get_frames_dropped() const;
 
     bool has_frames_left();
 
     void clear();
 
+    static const unsigned int max_frames_per_key = 255;
+    static const unsigned int fine_frames = 5 * 60; // How long history is kept frame by frame
+    static const unsigned int max_level   = 3;
+
 private:
-    RewindSeries *rewind_series;
-    unsigned int num_of_series;
-    unsigned int pos, last_pos;
+    struct Snapshot {
+        u64 frame;
+        State state;
+    };
+
+    void worker();
+    void flush();
+
+    // Everything below is only called with history_mutex locked
+    void add(const Snapshot &snapshot);
+    void thin();
+    void trim();
+
+    void start_series(const Snapshot &snapshot);
+    void remove_series();
+
+    // Keeps the last key used, as most of the time the next frame uses it too
+    void decompress_key(const RewindSeries &series, RewindCodec &codec, State &key, u64 &key_id);
+
+    SpscQueue<Snapshot> snapshots;
+
+    std::thread worker_thread;
+    std::mutex wake_mutex;
+    std::condition_variable wake;    // Signaled when there is a snapshot, or it's time to quit
+    std::condition_variable drained; // Signaled when the worker has caught up
+    bool quit;
+
+    std::mutex history_mutex;
+    std::deque <RewindSeries> history;
+    std::size_t memory_used;
+    unsigned int state_size;
+    u64 next_id;
+
+    // Only used by the worker
+    RewindCodec worker_codec;
+    State worker_key;
+    u64 worker_key_id;
+    std::vector <u8> zeros;
+
+    // Only used by the emulation thread
+    RewindCodec pop_codec;
+    State pop_key;
+    u64 pop_key_id;
+    State state;
+
+    u64 frame;
+    u64 length;   // In frames
+    std::size_t memory_budget; // In bytes, zero is no limit
+    unsigned int frames_dropped;
 
     bool out_of_frames;
 };
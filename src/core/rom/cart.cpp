@@ -18,24 +18,26 @@
 #include "core/rom/mbc2.hpp"
 #include "core/rom/mbc3.hpp"
 #include "core/rom/mbc5.hpp"
+#include "core/rom/rom_image.hpp"
 #include "core/state.hpp"
 #include "common/logger.hpp"
 #include "common/binary_file.hpp"
 #include "common/file_utils.hpp"
 
 #include <iostream>
+#include <algorithm>
 
 Cart::Cart() {
     data  = nullptr;
     ecart = nullptr;
 
+    rom_length = ecart_length = 0;
+
     rom_usage = nullptr;
 }
 
 Cart::~Cart() {
     // Free the data
-    if (data != nullptr)
-        delete[] data;
     if (ecart != nullptr)
         delete[] ecart;
 
@@ -43,18 +45,34 @@ Cart::~Cart() {
         delete[] rom_usage;
 }
 
-void Cart::init() {
-    // Allocate the data
-    data  = new byte[rom_size()];
-    ecart = new byte[ecart_size()];
+void Cart::init(unsigned int rom_size, unsigned int ram_size) {
+    // Banks are mirrored by masking the bank number, so round up to a power of two
+    rom_length = 0x8000;
+    while (rom_length < rom_size)
+        rom_length <<= 1;
 
-    rom_usage = new byte[rom_size()];
+    rom_length = std::min(rom_length, max_rom_size());
+
+    // Always have at least one bank of RAM, as some carts use RAM that isn't in the header
+    ecart_length = 0x2000;
+    while (ecart_length < ram_size)
+        ecart_length <<= 1;
+
+    ecart_length = std::min(ecart_length, max_ecart_size());
+
+    // Allocate the data
+    ecart = new byte[ecart_length];
 
     // Clear the data
-    std::fill(data,  data+rom_size   (), 0);
-    std::fill(ecart, ecart+ecart_size(), 0);
+    std::fill(ecart, ecart+ecart_length, 0);
+}
 
-    std::fill(rom_usage, rom_usage+rom_size(), 0);
+unsigned int Cart::rom_size() const {
+    return rom_length;
+}
+
+unsigned int Cart::ecart_size() const {
+    return ecart_length;
 }
 
 int Cart::load_ecart(const std::string &file_path) {
@@ -81,8 +99,9 @@ int Cart::load_ecart(const std::string &file_path) {
                 LOG_ERROR("Cart::load_ecart Unable to load RTC");
         }
 
-        if (size == ecart_size())
-            file.read(ecart, size);
+        // Older saves were always as big as the mapper's largest RAM, so only use what is needed
+        if (size >= ecart_size())
+            file.read(ecart, ecart_size());
         else
             LOG_ERROR("Cart::load_ecart Invalid ECART file size");
     }
@@ -114,12 +133,19 @@ void Cart::save_ecart(const std::string &file_path) {
     }
 }
 
-void Cart::load_data(BinaryFile &file) {
-    file.read(data, file.size());
+int Cart::load_data(const std::string &file_path, word checksum) {
+    image = RomImage::load(file_path, checksum, rom_size());
+
+    if (image == nullptr)
+        return -1;
+
+    data = image->get_data();
 
     Mbc1 *mbc1 = dynamic_cast<Mbc1*>(this);
     if (mbc1 != nullptr)
         mbc1->check_multicart();
+
+    return 0;
 }
 
 void Cart::set_rom_type(byte rom_type) {
@@ -146,7 +172,18 @@ const byte *Cart::get_usage() const {
     return rom_usage;
 }
 
+void Cart::init_usage() {
+    if (rom_usage != nullptr)
+        delete[] rom_usage;
+
+    rom_usage = new byte[rom_size()];
+    std::fill(rom_usage, rom_usage+rom_size(), 0);
+}
+
 int Cart::load_usage(const std::string &file_name) {
+    if (rom_usage == nullptr)
+        return -1;
+
     BinaryFile file(file_name + ".usage", BinaryFile::Mode_Read);
 
     if (!file.is_open())
@@ -162,6 +199,9 @@ int Cart::load_usage(const std::string &file_name) {
 }
 
 int Cart::dump_usage(const std::string &file_name) const {
+    if (rom_usage == nullptr)
+        return -1;
+
     BinaryFile file(file_name + ".usage", BinaryFile::Mode_Write);
 
     if (!file.is_open())
@@ -17,25 +17,33 @@
 
 #include "core/types.hpp"
 
+#include <memory>
 #include <string>
 
 class State;
-class BinaryFile;
+class RomImage;
 
 class Cart {
 public:
     Cart();
     virtual ~Cart();
 
-    void init();
+    // Allocates the ROM and external RAM, sized from the header (and the file size, for
+    // the ROM), and rounded up to whole banks up to the most the mapper can address
+    virtual void init(unsigned int rom_size, unsigned int ram_size);
 
     int load_ecart (const std::string &file_path);
     void save_ecart(const std::string &file_path);
 
-    void load_data(BinaryFile &file);
+    // Loads the ROM data, shared with any other carts using the same ROM
+    int load_data(const std::string &file_path, word checksum);
 
-    virtual unsigned int rom_size  () const = 0;
-    virtual unsigned int ecart_size() const = 0;
+    unsigned int rom_size  () const;
+    unsigned int ecart_size() const;
+
+    // The largest ROM and external RAM the mapper can address
+    virtual unsigned int max_rom_size  () const = 0;
+    virtual unsigned int max_ecart_size() const = 0;
 
     enum UsageType {
         UsageType_Data       = 1,
@@ -46,6 +54,9 @@ public:
     virtual byte read_byte(word address, UsageType usage) = 0;
     virtual void write_byte(word address, byte value) = 0;
 
+    // Returns a pointer to the ROM data currently mapped at address
+    virtual const byte *get_rom_page(word address) const = 0;
+
     void set_rom_type(byte rom_type);
 
     void save_state(State &state);
@@ -55,13 +66,21 @@ public:
 
     virtual int get_usage(word address) = 0;
 
+    // The usage is only allocated once it is needed
+    void init_usage();
+
     int load_usage(const std::string &file_name);
     int dump_usage(const std::string &file_name) const;
 
 protected:
-    byte *data;
+    std::shared_ptr<const RomImage> image;
+
+    const byte *data;
     byte *ecart;
 
+    unsigned int rom_length;
+    unsigned int ecart_length;
+
     byte *rom_usage;
 
     byte rom_type;
@@ -20,8 +20,9 @@
 #include "common/string_utils.hpp"
 
 #include <fstream>
+#include <algorithm>
 
-Mbc::Mbc(int rom_size_num, int ram_size_num) : Cart() {
+Mbc::Mbc() : Cart() {
     rom_offset = 0x4000;
     ram_offset = 0;
 
@@ -29,8 +30,16 @@ Mbc::Mbc(int rom_size_num, int ram_size_num) : Cart() {
     rom_bank = 0;
     ram_bank = 0;
 
-    rom_bank_mask = (rom_size_num / 0x4000) - 1;
-    ram_bank_mask = (ram_size_num / 0x2000) - 1;
+    rom_bank_mask = 0;
+    ram_bank_mask = 0;
+}
+
+void Mbc::init(unsigned int rom_size, unsigned int ram_size) {
+    Cart::init(rom_size, ram_size);
+
+    // Banks past the end of the ROM/RAM wrap around
+    rom_bank_mask = (this->rom_size() / 0x4000) - 1;
+    ram_bank_mask = std::max(ecart_size() / 0x2000, 1u) - 1;
 }
 
 bool Mbc::ram_enabled() const {
@@ -69,7 +78,18 @@ void Mbc::load_state(State &state) {
     ram_bank_mask = state.read16();
 }
 
+const byte *Mbc::get_rom_page(word address) const {
+    if (address <= 0x3FFF)
+        return data + address;
+
+    else // address <= 0x7FFF
+        return data + rom_offset + (address - 0x4000);
+}
+
 int Mbc::get_usage(word address) {
+    if (rom_usage == nullptr)
+        return 0;
+
     if (address <= 0x3FFF)
         return rom_usage[address];
 
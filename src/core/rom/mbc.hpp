@@ -19,7 +19,9 @@
 
 class Mbc : public Cart {
 public:
-    Mbc(int rom_size_num, int ram_size_num);
+    Mbc();
+
+    void init(unsigned int rom_size, unsigned int ram_size) override;
 
     bool ram_enabled() const;
     int get_ram_bank() const;
@@ -30,6 +32,8 @@ public:
 
     int get_usage(word address) override;
 
+    const byte *get_rom_page(word address) const override;
+
 protected:
     u32 rom_offset;
     u32 ram_offset;
@@ -18,18 +18,18 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
-Mbc1::Mbc1(int rom_size_num, int ram_size_num) : Mbc(rom_size_num, ram_size_num) {
+Mbc1::Mbc1() : Mbc() {
     mode = 0;
 
     hi_bank  = 0;
     rom_bank = 1;
 }
 
-unsigned int Mbc1::rom_size() const {
+unsigned int Mbc1::max_rom_size() const {
     return (0x4000 * 128);
 }
 
-unsigned int Mbc1::ecart_size() const {
+unsigned int Mbc1::max_ecart_size() const {
     return (0x2000 * 4);
 }
 
@@ -37,20 +37,15 @@ byte Mbc1::read_byte(word address, UsageType usage) {
     if (address <= 0x3FFF) {
         if (mode) {
             int offset = ((hi_bank << get_hi_shift()) & rom_bank_mask) * 0x4000;
-
-            rom_usage  [offset + address] = usage;
             return data[offset + address];
         }
         else {
-            rom_usage[address] = usage;
             return data[address];
         }
     }
 
-    else if (address <= 0x7FFF) {
-        rom_usage  [rom_offset + (address - 0x4000)] = usage;
+    else if (address <= 0x7FFF)
         return data[rom_offset + (address - 0x4000)];
-    }
 
     else if (address >= 0xA000 && address <= 0xBFFF) {
         if (ram_on)
@@ -104,10 +99,21 @@ void Mbc1::write_byte(word address, byte value) {
         LOG_WARNING("Mbc1::write_byte can't access address 0x" + StringUtils::hex(address));
 }
 
+const byte *Mbc1::get_rom_page(word address) const {
+    if (address <= 0x3FFF && mode)
+        return data + ((hi_bank << get_hi_shift()) & rom_bank_mask) * 0x4000 + address;
+
+    return Mbc::get_rom_page(address);
+}
+
 void Mbc1::check_multicart() {
     int count = 0;
 
-    for (int bank = 0; bank < 4; bank++) {
+    for (unsigned int bank = 0; bank < 4; bank++) {
+        // Too small to be a multicart
+        if ((bank+1) * 0x40000 > rom_size())
+            break;
+
         bool compare = 1;
 
         for (int addr = 0x0104; addr <= 0x0133; addr++) {
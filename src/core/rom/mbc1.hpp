@@ -20,14 +20,16 @@
 class Mbc1 : public Mbc
 {
 public:
-    Mbc1(int rom_size_num, int ram_size_num);
+    Mbc1();
 
-    unsigned int rom_size  () const override;
-    unsigned int ecart_size() const override;
+    unsigned int max_rom_size  () const override;
+    unsigned int max_ecart_size() const override;
 
     byte read_byte(word address, UsageType usage) override;
     void write_byte(word address, byte value) override;
 
+    const byte *get_rom_page(word address) const override;
+
     void check_multicart();
 
     bool get_mode() const;
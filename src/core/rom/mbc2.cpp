@@ -17,27 +17,23 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
-Mbc2::Mbc2(int rom_size_num, int ram_size_num) : Mbc(rom_size_num, ram_size_num) {
+Mbc2::Mbc2() : Mbc() {
 }
 
-unsigned int Mbc2::rom_size() const {
+unsigned int Mbc2::max_rom_size() const {
     return (0x4000 * 16);
 }
 
-unsigned int Mbc2::ecart_size() const {
+unsigned int Mbc2::max_ecart_size() const {
     return 512;
 }
 
 byte Mbc2::read_byte(word address, UsageType usage) {
-    if (address <= 0x3FFF) {
-        rom_usage[address] = usage;
+    if (address <= 0x3FFF)
         return data[address];
-    }
 
-    else if (address <= 0x7FFF) {
-        rom_usage  [rom_offset + (address - 0x4000)] = usage;
+    else if (address <= 0x7FFF)
         return data[rom_offset + (address - 0x4000)];
-    }
 
     else if (address >= 0xA000 && address <= 0xBFFF) {
         if (ram_on)
@@ -20,10 +20,10 @@
 class Mbc2 : public Mbc
 {
 public:
-    Mbc2(int rom_size_num, int ram_size_num);
+    Mbc2();
 
-    unsigned int rom_size  () const override;
-    unsigned int ecart_size() const override;
+    unsigned int max_rom_size  () const override;
+    unsigned int max_ecart_size() const override;
 
     byte read_byte(word address, UsageType usage) override;
     void write_byte(word address, byte value) override;
@@ -19,33 +19,29 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
-Mbc3::Mbc3(int rom_size_num, int ram_size_num) : Mbc(rom_size_num, ram_size_num) {
+Mbc3::Mbc3() : Mbc() {
 }
 
-unsigned int Mbc3::rom_size() const {
+unsigned int Mbc3::max_rom_size() const {
     return (0x4000 * 128);
 }
 
-unsigned int Mbc3::ecart_size() const {
+unsigned int Mbc3::max_ecart_size() const {
     return (4 * 0x2000);
 }
 
 byte Mbc3::read_byte(word address, UsageType usage) {
-    if (address <= 0x3FFF) {
-        rom_usage[address] = usage;
+    if (address <= 0x3FFF)
         return data[address];
-    }
 
-    else if (address <= 0x7FFF) {
-        rom_usage  [rom_offset + (address - 0x4000)] = usage;
+    else if (address <= 0x7FFF)
         return data[rom_offset + (address - 0x4000)];
-    }
 
     else if (address >= 0xA000 && address <= 0xBFFF) {
         if (ram_on) {
             if (ram_bank <= 0x03) {
                 if (rom_type == 0x10 || rom_type == 0x12 || rom_type == 0x13) {
-                    ram_offset = ram_bank * 0x2000;
+                    ram_offset = (ram_bank & ram_bank_mask) * 0x2000;
                     return ecart[ram_offset + (address - 0xA000)];
                 }
             }
@@ -74,7 +70,7 @@ void Mbc3::write_byte(word address, byte value) {
     else if(address <= 0x3FFF) {
         rom_bank = value & 0x7F;
         if (!rom_bank) rom_bank = 0x01;
-        rom_offset = rom_bank * 0x4000;
+        rom_offset = (rom_bank & rom_bank_mask) * 0x4000;
     }
 
     // RAM Bank Number - or - RTC Register Select
@@ -93,7 +89,7 @@ void Mbc3::write_byte(word address, byte value) {
         if (ram_on) {
             if (ram_bank <= 0x03) {
                 if (rom_type == 0x10 || rom_type == 0x12 || rom_type == 0x13) {
-                    ram_offset = ram_bank * 0x2000;
+                    ram_offset = (ram_bank & ram_bank_mask) * 0x2000;
                     ecart[ram_offset + (address - 0xA000)] = value;
                 }
             }
@@ -116,3 +112,11 @@ int Mbc3::load_timer(const std::string &file_path) {
 int Mbc3::save_timer(const std::string &file_path) {
     return rtc.save(file_path);
 }
+
+const Rtc &Mbc3::get_timer() const {
+    return rtc;
+}
+
+void Mbc3::set_timer(const Rtc &rtc) {
+    this->rtc = rtc;
+}
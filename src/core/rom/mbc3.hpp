@@ -21,10 +21,10 @@
 class Mbc3 : public Mbc
 {
 public:
-    Mbc3(int rom_size_num, int ram_size_num);
+    Mbc3();
 
-    unsigned int rom_size  () const override;
-    unsigned int ecart_size() const override;
+    unsigned int max_rom_size  () const override;
+    unsigned int max_ecart_size() const override;
 
     byte read_byte(word address, UsageType usage) override;
     void write_byte(word address, byte value) override;
@@ -32,6 +32,9 @@ public:
     int load_timer(const std::string &file_path);
     int save_timer(const std::string &file_path);
 
+    const Rtc &get_timer() const;
+    void set_timer(const Rtc &rtc);
+
 protected:
     //void mbc_save_state(State &state) override;
     //void mbc_load_state(State &state) override;
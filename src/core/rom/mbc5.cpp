@@ -17,27 +17,23 @@
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 
-Mbc5::Mbc5(int rom_size_num, int ram_size_num) : Mbc(rom_size_num, ram_size_num) {
+Mbc5::Mbc5() : Mbc() {
 }
 
-unsigned int Mbc5::rom_size() const {
+unsigned int Mbc5::max_rom_size() const {
     return (0x4000 * 512);
 }
 
-unsigned int Mbc5::ecart_size() const {
+unsigned int Mbc5::max_ecart_size() const {
     return (16 * 0x2000);
 }
 
 byte Mbc5::read_byte(word address, UsageType usage) {
-    if (address <= 0x3FFF) {
-        rom_usage[address] = usage;
+    if (address <= 0x3FFF)
         return data[address];
-    }
 
-    else if (address <= 0x7FFF) {
-        rom_usage  [rom_offset + (address - 0x4000)] = usage;
+    else if (address <= 0x7FFF)
         return data[rom_offset + (address - 0x4000)];
-    }
 
     else if (address >= 0xA000 && address <= 0xBFFF) {
         if (rom_type == 0x1A || rom_type == 0x1B || rom_type == 0x1D || rom_type == 0x1E) {
@@ -75,7 +71,7 @@ void Mbc5::write_byte(word address, byte value) {
 
     else if (address <= 0x5FFF) {
         ram_bank = value & 0x0F;
-        ram_offset = 0x2000 * ram_bank;
+        ram_offset = 0x2000 * (ram_bank & ram_bank_mask);
     }
 
     else if (address >= 0xA000 && address <= 0xBFFF) {
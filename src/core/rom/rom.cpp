@@ -18,8 +18,10 @@
 #include "core/rom/mbc2.hpp"
 #include "core/rom/mbc3.hpp"
 #include "core/rom/mbc5.hpp"
+#include "core/rom/usage_tracker.hpp"
 #include "core/defs.hpp"
 #include "core/gameboy.hpp"
+#include "core/memory/mmu.hpp"
 #include "core/state.hpp"
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
@@ -27,11 +29,21 @@
 #include "common/file_utils.hpp"
 
 #include <ctime>
+#include <algorithm>
+
+template <class T>
+static Cart *new_cart(bool usage_tracking) {
+    if (usage_tracking)
+        return new UsageTracker<T>;
+
+    return new T;
+}
 
 Rom::Rom(GameBoy *gb) : Component(gb) {
     cart = nullptr;
 
-    dump_usage = false;
+    dump_usage     = false;
+    usage_tracking = false;
 }
 
 Rom::~Rom() {
@@ -56,13 +68,14 @@ int Rom::load_rom(const std::string &rom_path, std::string &error) {
     }
 
     unsigned int size = file.size();
+    file_size = size;
 
-    if (size < 0x14F)  {
+    if (size < 0x150)  {
         error = "File too small";
         return -2; // File too small
     }
 
-    file.read(header, 0x14F);
+    file.read(header, 0x150);
     file.seek(0, BinaryFile::Pos_Beg);
 
     byte rom_type = header[0x147];
@@ -80,49 +93,22 @@ int Rom::load_rom(const std::string &rom_path, std::string &error) {
             LOG_WARNING("Rom::load_rom unknown ram-size 0x" + StringUtils::hex(header[0x149]));
     }
 
-    if (cart != nullptr)
+    if (cart != nullptr) {
         delete cart;
+        cart = nullptr;
 
-    switch (rom_type) {
-        case 0x00:
-            cart = new Plain;
-            break;
-
-        case 0x1:
-        case 0x2:
-        case 0x3:
-            cart = new Mbc1(rom_size_num, ram_size_num);
-            break;
-
-        case 0x5:
-        case 0x6:
-            cart = new Mbc2(rom_size_num, ram_size_num);
-            break;
-
-        case 0x0F:
-        case 0x10:
-        case 0x11:
-        case 0x12:
-        case 0x13:
-            cart = new Mbc3(rom_size_num, ram_size_num);
-            break;
+        gb->mmu->remap(0x0000, 0x7FFF); // Don't leave any pages pointing to the old cart
+    }
 
-        case 0x19:
-        case 0x1A:
-        case 0x1B:
-        case 0x1C:
-        case 0x1D:
-        case 0x1E:
-            cart = new Mbc5(rom_size_num, ram_size_num);
-            break;
+    cart = create_cart(rom_type);
 
-        default:
-            file.close();
-            error = "Unknown Rom-Type: 0x" + StringUtils::hex(rom_type);
-            return -1;
+    if (cart == nullptr) {
+        file.close();
+        error = "Unknown Rom-Type: 0x" + StringUtils::hex(rom_type);
+        return -1;
     }
 
-    if (size > cart->rom_size()) {
+    if (size > cart->max_rom_size()) {
         error = "File too big";
         return -1;
     }
@@ -132,11 +118,20 @@ int Rom::load_rom(const std::string &rom_path, std::string &error) {
         return -1;
     }
 
-    // Load the cart data
-    cart->init();
-    cart->load_data(file);
+    // Load the cart data, some ROMs are bigger than their header says
+    cart->init(std::max(rom_size_num, size), ram_size_num);
     cart->set_rom_type(rom_type);
 
+    file.close();
+
+    if (cart->load_data(rom_path, header[0x14E] << 8 | header[0x14F]) < 0) {
+        delete cart;
+        cart = nullptr;
+
+        error = "Unable to read file";
+        return -1;
+    }
+
     logo_match = true;
 
     for (int num = 0x104; num <= 0x133; num++) {
@@ -160,7 +155,7 @@ int Rom::load_rom(const std::string &rom_path, std::string &error) {
     if (ram_size_num > 0 || rom_type == 0x06)
         cart->load_ecart(File::remove_extension(path));
 
-    cart->load_usage(File::remove_extension(path));
+    gb->mmu->remap(0x0000, 0x7FFF);
 
     return 0;
 }
@@ -181,6 +176,14 @@ byte Rom::read_operand(word address) {
     return cart->read_byte(address, Cart::UsageType_Instr);
 }
 
+const byte *Rom::get_read_page(word address) {
+    // The usage has to be tracked on every access
+    if (cart == nullptr || usage_tracking || address > 0x7FFF)
+        return nullptr;
+
+    return cart->get_rom_page(address);
+}
+
 const byte *Rom::get_rom_usage() const {
     return cart->get_usage();
 }
@@ -322,6 +325,8 @@ void Rom::save_state(State &state) {
 
 void Rom::load_state(State &state) {
     cart->load_state(state);
+
+    gb->mmu->remap(0x0000, 0x7FFF);
 }
 
 
@@ -366,24 +371,111 @@ bool Rom::get_mbc1_mode() const {
 
 void Rom::set_dump_usage(bool dump_usage) {
     this->dump_usage = dump_usage;
+
+    if (!dump_usage || usage_tracking)
+        return;
+
+    set_usage_tracking(true);
+
+    // Carry on from the last time the usage was dumped
+    if (cart != nullptr)
+        cart->load_usage(File::remove_extension(path));
+}
+
+void Rom::set_usage_tracking(bool usage_tracking) {
+    if (this->usage_tracking == usage_tracking)
+        return;
+
+    this->usage_tracking = usage_tracking;
+
+    if (cart == nullptr)
+        return;
+
+    Cart *old_cart = cart;
+
+    cart = create_cart(header[0x147]);
+    cart->init(std::max(rom_size_num, file_size), ram_size_num);
+    cart->set_rom_type(header[0x147]);
+
+    // The ROM data is shared with the old cart, so this doesn't read the file again
+    if (cart->load_data(path, header[0x14E] << 8 | header[0x14F]) < 0) {
+        LOG_ERROR("Rom::set_usage_tracking Unable to read ROM data");
+
+        delete cart;
+        cart = old_cart;
+
+        this->usage_tracking = !usage_tracking;
+        return;
+    }
+
+    // Carry the external RAM and the mapper over to the new cart
+    State state;
+    old_cart->save_state(state);
+    cart->load_state(state);
+
+    Mbc3 *mbc3 = dynamic_cast<Mbc3*>(old_cart);
+    if (mbc3 != nullptr)
+        dynamic_cast<Mbc3*>(cart)->set_timer(mbc3->get_timer());
+
+    delete old_cart;
+
+    gb->mmu->remap(0x0000, 0x7FFF);
+}
+
+bool Rom::is_usage_tracked() const {
+    return usage_tracking;
+}
+
+Cart *Rom::create_cart(byte rom_type) const {
+    switch (rom_type) {
+        case 0x00:
+            return new_cart<Plain>(usage_tracking);
+
+        case 0x1:
+        case 0x2:
+        case 0x3:
+            return new_cart<Mbc1>(usage_tracking);
+
+        case 0x5:
+        case 0x6:
+            return new_cart<Mbc2>(usage_tracking);
+
+        case 0x0F:
+        case 0x10:
+        case 0x11:
+        case 0x12:
+        case 0x13:
+            return new_cart<Mbc3>(usage_tracking);
+
+        case 0x19:
+        case 0x1A:
+        case 0x1B:
+        case 0x1C:
+        case 0x1D:
+        case 0x1E:
+            return new_cart<Mbc5>(usage_tracking);
+
+        default:
+            break;
+    }
+
+    return nullptr;
 }
 
 Plain::Plain() : Cart() {
 }
 
-unsigned int Plain::rom_size() const {
+unsigned int Plain::max_rom_size() const {
     return 0x8000;
 }
 
-unsigned int Plain::ecart_size() const {
+unsigned int Plain::max_ecart_size() const {
     return (8 * 1024);
 }
 
 byte Plain::read_byte(word address, UsageType usage) {
-    if (address <= 0x7FFF) {
-        rom_usage[address] = usage;
+    if (address <= 0x7FFF)
         return data[address];
-    }
 
     else if (address >= 0xA000 && address <= 0xBFFF)
         return ecart[address - 0xA000];
@@ -393,6 +485,10 @@ byte Plain::read_byte(word address, UsageType usage) {
     return 0;
 }
 
+const byte *Plain::get_rom_page(word address) const {
+    return data + address;
+}
+
 void Plain::write_byte(word address, byte value) {
     if (address >= 0xA000 && address <= 0xBFFF)
         ecart[address - 0xA000] = value;
@@ -402,5 +498,8 @@ void Plain::write_byte(word address, byte value) {
 }
 
 int Plain::get_usage(word address) {
+    if (rom_usage == nullptr)
+        return 0;
+
     return rom_usage[address];
 }
@@ -39,6 +39,8 @@ public:
     byte read_instruction(word address);
     byte read_operand    (word address);
 
+    const byte *get_read_page(word address) override;
+
     const byte *get_rom_usage() const;
     int get_rom_usage(word address) const;
 
@@ -74,7 +76,13 @@ public:
 
     void set_dump_usage(bool dump_usage);
 
+    // Swaps the cart for one that tracks the ROM usage, keeping its state
+    void set_usage_tracking(bool usage_tracking);
+    bool is_usage_tracked() const;
+
 private:
+    Cart *create_cart(byte rom_type) const;
+
     const byte logo[48] = {
         0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B, 0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D,
         0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E, 0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99,
@@ -85,8 +93,9 @@ private:
 
     unsigned int rom_size_num;
     unsigned int ram_size_num;
+    unsigned int file_size;
 
-    byte header[0x14F];
+    byte header[0x150];
 
     byte checksum;
     bool logo_match;
@@ -95,17 +104,20 @@ private:
 
     Cart *cart;
     bool dump_usage;
+    bool usage_tracking;
 };
 
 class Plain : public Cart {
 public:
     Plain();
 
-    unsigned int rom_size() const;
-    unsigned int ecart_size() const;
+    unsigned int max_rom_size() const;
+    unsigned int max_ecart_size() const;
 
     byte read_byte(word address, UsageType usage);
     void write_byte(word address, byte value);
 
+    const byte *get_rom_page(word address) const;
+
     int get_usage(word address);
 };
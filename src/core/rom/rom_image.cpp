@@ -0,0 +1,101 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/rom/rom_image.hpp"
+#include "common/binary_file.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+std::mutex RomImage::cache_mutex;
+std::map <RomImage::Key, std::weak_ptr<const RomImage>> RomImage::cache;
+
+RomImage::RomImage() {
+    buffer = nullptr;
+    size   = 0;
+}
+
+RomImage::~RomImage() {
+    if (buffer != nullptr)
+        delete[] buffer;
+}
+
+std::shared_ptr<const RomImage> RomImage::load(const std::string &path, word checksum, unsigned int size) {
+    std::error_code error;
+    std::string full_path = std::filesystem::weakly_canonical(path, error).string();
+
+    if (error)
+        full_path = path;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    // Forget about the images that nobody is using anymore
+    for (auto i = cache.begin(); i != cache.end();) {
+        if (i->second.expired())
+            i = cache.erase(i);
+        else
+            i++;
+    }
+
+    Key key(full_path, checksum, size);
+
+    // The last user might have let go of it on another thread since the purge,
+    // in which case it is mapped again and takes the old entry's place
+    auto cached = cache.find(key);
+    if (cached != cache.end()) {
+        if (auto image = cached->second.lock())
+            return image;
+    }
+
+    std::shared_ptr<RomImage> image(new RomImage);
+
+    if (image->open(path, size) < 0)
+        return nullptr;
+
+    cache[key] = image;
+
+    return image;
+}
+
+const byte *RomImage::get_data() const {
+    return buffer != nullptr ? buffer : file.data();
+}
+
+unsigned int RomImage::get_size() const {
+    return size;
+}
+
+int RomImage::open(const std::string &path, unsigned int size) {
+    this->size = size;
+
+    if (file.open(path)) {
+        if (file.size() == size)
+            return 0;
+
+        file.close();
+    }
+
+    BinaryFile binary_file(path, BinaryFile::Mode_Read);
+
+    if (!binary_file.is_open())
+        return -1;
+
+    buffer = new byte[size];
+    std::fill(buffer, buffer+size, 0);
+
+    binary_file.read(buffer, std::min(binary_file.size(), size));
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+#include "common/mapped_file.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// The read-only contents of a ROM file.
+//
+// Every cart that loads the same ROM (same path, checksum and size) shares a
+// single image, so running lots of instances of a game only keeps one copy in memory.
+class RomImage
+{
+public:
+    ~RomImage();
+
+    // Returns the image of the ROM at path, padded with zeros up to size bytes,
+    // or nullptr if the file couldn't be read
+    static std::shared_ptr<const RomImage> load(const std::string &path, word checksum, unsigned int size);
+
+    const byte *get_data() const;
+    unsigned int get_size() const;
+
+private:
+    RomImage();
+
+    int open(const std::string &path, unsigned int size);
+
+    // The file is mapped directly when it is exactly the right size,
+    // otherwise it is copied into a buffer
+    MappedFile file;
+    byte *buffer;
+
+    unsigned int size;
+
+    typedef std::tuple <std::string, word, unsigned int> Key;
+
+    static std::mutex cache_mutex;
+    static std::map <Key, std::weak_ptr<const RomImage>> cache;
+};
@@ -0,0 +1,39 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/rom/cart.hpp"
+
+// Adds ROM usage tracking to a cart.
+//
+// The carts themselves don't know about the usage, so the normal carts pay nothing for it,
+// and this variant is only created when the usage is actually wanted.
+template <class T>
+class UsageTracker : public T
+{
+public:
+    void init(unsigned int rom_size, unsigned int ram_size) override {
+        T::init(rom_size, ram_size);
+        this->init_usage();
+    }
+
+    byte read_byte(word address, Cart::UsageType usage) override {
+        if (address <= 0x7FFF)
+            this->rom_usage[T::get_rom_page(address) - this->data] = usage;
+
+        return T::read_byte(address, usage);
+    }
+};
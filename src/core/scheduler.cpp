@@ -0,0 +1,150 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "core/scheduler.hpp"
+#include "core/gameboy.hpp"
+#include "core/memory/dma.hpp"
+#include "core/cpu/timer.hpp"
+#include "core/serial/serial.hpp"
+#include "core/gpu/gpu.hpp"
+#include "core/audio/apu.hpp"
+
+#include <algorithm>
+
+// A frame in machine cycles, the GPU always has an event before then anyway
+#define MAX_SKIP (70224 / 4)
+
+Scheduler::Scheduler(GameBoy *gb) {
+    this->gb = gb;
+
+    fast_clock  = slow_clock  = 0;
+    fast_synced = slow_synced = 0;
+    fast_event  = slow_event  = 0;
+    event_generation = 0;
+
+    exact = true;
+}
+
+void Scheduler::tick4(bool double_speed) {
+    if (exact) {
+        if (double_speed) {
+            tick();
+            tick_double_speed();
+            tick();
+            tick_double_speed();
+        }
+        else {
+            tick();
+            tick();
+            tick();
+            tick();
+        }
+
+        fast_clock += 4;
+        slow_clock += double_speed ? 2 : 4;
+
+        fast_synced = fast_clock;
+        slow_synced = slow_clock;
+
+        update();
+        return;
+    }
+
+    fast_clock += 4;
+    slow_clock += double_speed ? 2 : 4;
+
+    if (fast_clock >= fast_event || slow_clock >= slow_event)
+        sync();
+}
+
+int Scheduler::cycles_to_event(bool double_speed) const {
+    if (exact || fast_clock >= fast_event || slow_clock >= slow_event)
+        return 0;
+
+    // Another device could clock in the last bit of a transfer at any time
+    if (gb->serial->is_externally_clocked())
+        return 0;
+
+    u64 fast = (fast_event - fast_clock + 3) / 4;
+    u64 slow = (slow_event - slow_clock + (double_speed ? 1 : 3)) / (double_speed ? 2 : 4);
+
+    return std::min<u64>(std::min(fast, slow), MAX_SKIP);
+}
+
+void Scheduler::skip(int cycles, bool double_speed) {
+    fast_clock += cycles * 4;
+    slow_clock += cycles * (double_speed ? 2 : 4);
+}
+
+unsigned int Scheduler::get_event_generation() const {
+    return event_generation;
+}
+
+void Scheduler::sync() {
+    int fast = fast_clock - fast_synced;
+    int slow = slow_clock - slow_synced;
+
+    if (fast) {
+        gb->dma   ->advance(fast);
+        gb->timer ->advance(fast);
+        gb->serial->advance(fast);
+    }
+
+    if (slow) {
+        gb->gpu->advance(slow);
+        gb->apu->advance(slow);
+    }
+
+    fast_synced = fast_clock;
+    slow_synced = slow_clock;
+
+    update();
+}
+
+void Scheduler::update() {
+    int fast = std::min({gb->dma->next_event(), gb->timer->next_event(), gb->serial->next_event()});
+    int slow = std::min(gb->gpu->next_event(), gb->apu->next_event());
+
+    if (fast_synced + fast != fast_event || slow_synced + slow != slow_event)
+        event_generation++;
+
+    fast_event = fast_synced + fast;
+    slow_event = slow_synced + slow;
+
+    // The DMA reads from memory the CPU might be writing to, so unless
+    // it is copying in bulk, it has to stay in lock-step with everything else
+    exact = gb->dma->is_active();
+}
+
+void Scheduler::reset() {
+    fast_synced = fast_clock;
+    slow_synced = slow_clock;
+
+    update();
+}
+
+void Scheduler::tick() {
+    gb->dma   ->tick();
+    gb->timer ->tick();
+    gb->serial->tick();
+    gb->gpu   ->tick();
+    gb->apu   ->tick();
+}
+
+void Scheduler::tick_double_speed() {
+    gb->dma   ->tick();
+    gb->timer ->tick();
+    gb->serial->tick();
+}
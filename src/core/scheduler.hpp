@@ -0,0 +1,75 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "core/types.hpp"
+
+class GameBoy;
+
+// Keeps track of when each component next has to be brought up to date.
+//
+// Instead of ticking every component on every clock, the CPU only advances
+// the clocks here, and the components are caught up in bulk once the clock
+// reaches the earliest event that could be seen from the outside (an interrupt,
+// the end of a frame, an HDMA block, ...), or right before the CPU accesses them.
+//
+// DMA, the timer and the serial port run off the fast clock, which runs at
+// double the rate of the slow clock (GPU and APU) in double-speed mode.
+class Scheduler
+{
+public:
+    Scheduler(GameBoy *gb);
+
+    // Advances the clocks by one machine cycle
+    void tick4(bool double_speed);
+
+    // How many machine cycles until the next event, or 0 if time can't be skipped right now
+    int cycles_to_event(bool double_speed) const;
+
+    // Advances the clocks without running anything, for when the CPU is waiting
+    // and nothing can happen until the next event. Has to stop before it.
+    void skip(int cycles, bool double_speed);
+
+    // Changes every time the next event does, which it does when one happens
+    unsigned int get_event_generation() const;
+
+    // Brings every component up to the current time
+    void sync();
+
+    // Recalculates when the next event is, should be called after
+    // anything that could change that (register writes, etc)
+    void update();
+
+    // Forgets any time that hasn't been synced yet, used after loading a state
+    void reset();
+
+    // Returned by the components when there is no upcoming event
+    static const int NoEvent = 0x7FFFFFFF;
+
+private:
+    void tick();
+    void tick_double_speed();
+
+    GameBoy *gb;
+
+    u64 fast_clock, slow_clock;
+    u64 fast_synced, slow_synced;
+    u64 fast_event, slow_event;
+    unsigned int event_generation;
+
+    // When set every clock is run one by one, in the same order as on the hardware
+    bool exact;
+};
@@ -15,6 +15,7 @@
 
 #include "core/serial/serial.hpp"
 #include "core/gameboy.hpp"
+#include "core/scheduler.hpp"
 #include "core/state.hpp"
 #include "core/cpu/cpu.hpp"
 #include "core/defs.hpp"
@@ -57,6 +58,28 @@ void Serial::tick() {
     }
 }
 
+void Serial::advance(int ticks) {
+    while (ticks > 0 && internal_clock && transfering) {
+        // Nothing happens until the timer runs out
+        if (timer <= 0 || timer > ticks) {
+            timer -= ticks;
+            return;
+        }
+
+        ticks -= timer;
+
+        timer = 1;
+        tick();
+    }
+}
+
+int Serial::next_event() const {
+    if (!internal_clock || !transfering || timer <= 0)
+        return Scheduler::NoEvent;
+
+    return timer;
+}
+
 bool Serial::send() {
     return internal_clock ? 1 : (data & BIT7);
 }
@@ -146,6 +169,10 @@ void Serial::load_state(State &state) {
     internal_clock = state.read8();
 }
 
+bool Serial::is_externally_clocked() const {
+    return !internal_clock && transfering && serial_device != &null_serial_device;
+}
+
 void Serial::set_serial_device(SerialDevice *serial_device) {
     this->serial_device = serial_device ? serial_device : &null_serial_device;
 }
@@ -27,6 +27,9 @@ public:
     ~Serial();
 
     void tick();
+    void advance(int ticks);
+
+    int next_event() const;
 
     bool send();
     void receive(bool bit);
@@ -39,6 +42,9 @@ public:
 
     void set_serial_device(SerialDevice *serial_device);
 
+    // If a transfer is waiting on the clock from the other device
+    bool is_externally_clocked() const;
+
 private:
     void start_transfer();
     void check_transfer();
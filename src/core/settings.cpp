@@ -31,6 +31,9 @@ Settings::Settings() {
     audio_channel2_volume = 100;
     audio_channel3_volume = 100;
     audio_channel4_volume = 100;
+    audio_band_limited    = true;
+    audio_resampler_quality = 2;
+    audio_dynamic_rate    = true;
 
     // BIOS
     bios_dmg_path = "";
@@ -57,9 +60,12 @@ Settings::Settings() {
 
     // Video
     video_lock_aspect_ratio = true;
+    video_render_thread     = false;
+    video_turbo_frame_skip  = 3;
 
     // Emulation
     emu_rewind_length = 5 * 60;
+    emu_rewind_memory = 64;
     emu_sync_to_audio = true;
 }
 
@@ -97,6 +103,7 @@ void Settings::configure(GameBoy &gameboy, Display &display, AudioDriver &audio_
     input2.load_settings(*this, 1);
 
     rewinder.set_length(emu_rewind_length);
+    rewinder.set_memory_budget(emu_rewind_memory);
 }
 
 void Settings::load_audio(IniFile &ini) {
@@ -110,6 +117,16 @@ void Settings::load_audio(IniFile &ini) {
         audio_channel2_volume = audio->get_int("Channel2Volume");
         audio_channel3_volume = audio->get_int("Channel3Volume");
         audio_channel4_volume = audio->get_int("Channel4Volume");
+
+        // Older INI files don't have it
+        if (!audio->get_str("BandLimited").empty())
+            audio_band_limited = audio->get_bool("BandLimited");
+
+        if (!audio->get_str("ResamplerQuality").empty())
+            audio_resampler_quality = audio->get_int("ResamplerQuality");
+
+        if (!audio->get_str("DynamicRate").empty())
+            audio_dynamic_rate = audio->get_bool("DynamicRate");
     }
 }
 
@@ -152,8 +169,14 @@ void Settings::load_input(IniFile &ini) {
 void Settings::load_video(IniFile &ini) {
     IniFile::Section *video = ini.get_section("Video");
 
-    if (video)
+    if (video) {
         video_lock_aspect_ratio = video->get_bool("LockAspectRatio");
+        video_render_thread     = video->get_bool("RenderThread");
+
+        // Older INI files don't have it
+        if (!video->get_str("TurboFrameSkip").empty())
+            video_turbo_frame_skip = video->get_int("TurboFrameSkip");
+    }
 }
 
 void Settings::load_emulation(IniFile &ini) {
@@ -161,6 +184,11 @@ void Settings::load_emulation(IniFile &ini) {
 
     if (emulation) {
         emu_rewind_length = emulation->get_int("RewindLength");
+
+        // Older INI files don't have it
+        if (!emulation->get_str("RewindMemory").empty())
+            emu_rewind_memory = emulation->get_int("RewindMemory");
+
         emu_sync_to_audio = emulation->get_bool("SyncToAudio");
     }
 }
@@ -176,6 +204,9 @@ void Settings::save_audio(IniFile &ini) {
     audio->set_int("Channel2Volume", audio_channel2_volume);
     audio->set_int("Channel3Volume", audio_channel3_volume);
     audio->set_int("Channel4Volume", audio_channel4_volume);
+    audio->set_bool("BandLimited",   audio_band_limited);
+    audio->set_int("ResamplerQuality", audio_resampler_quality);
+    audio->set_bool("DynamicRate",   audio_dynamic_rate);
 }
 
 void Settings::save_bios(IniFile &ini) {
@@ -212,11 +243,14 @@ void Settings::save_video(IniFile &ini) {
     IniFile::Section *video = ini.get_or_create_section("Video");
 
     video->set_bool("LockAspectRatio", video_lock_aspect_ratio);
+    video->set_bool("RenderThread",    video_render_thread);
+    video->set_int("TurboFrameSkip",   video_turbo_frame_skip);
 }
 
 void Settings::save_emulation(IniFile &ini) {
     IniFile::Section *emulation = ini.get_or_create_section("Emulation");
 
     emulation->set_int("RewindLength", emu_rewind_length);
+    emulation->set_int("RewindMemory", emu_rewind_memory);
     emulation->set_bool("SyncToAudio", emu_sync_to_audio);
 }
@@ -43,6 +43,9 @@ public:
     unsigned int audio_channel2_volume; // Volume of Channel 2
     unsigned int audio_channel3_volume; // Volume of Channel 3
     unsigned int audio_channel4_volume; // Volume of Channel 4
+    bool audio_band_limited;            // Band-limited synthesis, instead of sampling the channels
+    unsigned int audio_resampler_quality; // Resampler quality, from 0 (low) to 2 (high)
+    bool audio_dynamic_rate;            // Nudge the sample-rate to keep the audio-buffer filled, when not syncing to audio
 
     // BIOS
     std::string bios_dmg_path; // GameBoy BIOS
@@ -69,9 +72,12 @@ public:
 
     // Video
     bool video_lock_aspect_ratio; // Lock the aspect-ratio of the display
+    bool video_render_thread;     // Draw the screen on a separate thread
+    unsigned int video_turbo_frame_skip; // How many frames to skip drawing in turbo mode
 
     // Emulation
     unsigned int emu_rewind_length; // How many seconds you can rewind back
+    unsigned int emu_rewind_memory; // How many megabytes rewinding can use
     bool emu_sync_to_audio;         // Sync emulation to audio
 
 
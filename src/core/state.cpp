@@ -14,107 +14,72 @@
 // along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
 
 #include "core/state.hpp"
-#include "common/string_utils.hpp"
+#include "common/binary_file.hpp"
 
-int State_File::open_read(const std::string &file_path) {
-    return file.open(file_path, BinaryFile::Mode_Read) ? 0 : -1;
-}
-
-int State_File::open_write(const std::string &file_path) {
-    return file.open(file_path, BinaryFile::Mode_Write) ? 0 : -1;
-}
-
-void State_File::close() {
-    file.close();
-}
+#include <algorithm>
 
-void State_File::write8(u8 value) {
-    file.write8(value);
+State::State() {
+    write_pos = 0;
+    read_pos  = 0;
 }
 
-void State_File::write16(u16 value) {
-    file.write16(value);
+void State::clear() {
+    write_pos = 0;
+    read_pos  = 0;
 }
 
-void State_File::write32(u32 value) {
-    file.write32(value);
+unsigned int State::size() const {
+    return write_pos;
 }
 
-void State_File::write_data(const void *data, unsigned int size) {
-    file.write(data, size);
+bool State::is_empty() const {
+    return write_pos == 0;
 }
 
-u8 State_File::read8() {
-    return file.read8();
+const u8 *State::get_data() const {
+    return memory.data();
 }
 
-u16 State_File::read16() {
-    return file.read16();
-}
-
-u32 State_File::read32() {
-    return file.read32();
-}
-
-void State_File::read_data(void *data, unsigned int size) {
-    file.read(data, size);
-}
+int State::save_file(const std::string &file_path) const {
+    BinaryFile file(file_path, BinaryFile::Mode_Write);
 
+    if (!file.is_open())
+        return -1;
 
-unsigned int State_Memory::size() const {
-    return memory.size();
+    return file.write(memory.data(), write_pos) ? 0 : -1;
 }
 
-bool State_Memory::is_empty() const {
-    return memory.empty();
-}
+int State::load_file(const std::string &file_path) {
+    BinaryFile file(file_path, BinaryFile::Mode_Read);
 
-void State_Memory::clear() {
-    memory.clear();
-}
+    if (!file.is_open())
+        return -1;
 
-void State_Memory::write8(u8 value) {
-    memory.push_back(value);
-}
+    clear();
 
-void State_Memory::write16(u16 value) {
-    memory.insert(memory.end(), (u8*)&value, (u8*)&value + sizeof(value));
-}
+    unsigned int size = file.size();
 
-void State_Memory::write32(u32 value) {
-    memory.insert(memory.end(), (u8*)&value, (u8*)&value + sizeof(value));
-}
+    grow(size);
 
-void State_Memory::write_data(const void *data, unsigned int size) {
-    memory.insert(memory.end(), (u8*)data, (u8*)data+size);
-}
+    if (!file.read(memory.data(), size))
+        return -1;
 
-u8 State_Memory::read8() {
-    u8 value = memory.front();
-    memory.erase(memory.begin());
+    write_pos = size;
 
-    return value;
+    return 0;
 }
 
-u16 State_Memory::read16() {
-    u16 value;
-
-    std::copy(memory.begin(), memory.begin()+sizeof(value), (u8*)&value);
-    memory.erase(memory.begin(), memory.begin()+sizeof(value));
-
-    return value;
+void State::grow(unsigned int size) {
+    memory.resize(std::max<std::size_t>(size, memory.size() * 2));
 }
 
-u32 State_Memory::read32() {
-    u32 value;
+// Reading past the end only happens with a truncated state, so just give back zeros
+void State::read_past_end(void *data, unsigned int size) {
+    unsigned int left = write_pos - read_pos;
 
-    std::copy(memory.begin(), memory.begin()+sizeof(value), (u8*)&value);
-    memory.erase(memory.begin(), memory.begin()+sizeof(value));
-
-    return value;
-}
+    if (left)
+        std::memcpy(data, memory.data() + read_pos, left);
+    std::memset((u8*)data + left, 0, size - left);
 
-void State_Memory::read_data(void *data, unsigned int size) {
-    std::copy(memory.begin(), memory.begin()+size, (u8*)data);
-    memory.erase(memory.begin(), memory.begin()+size);
+    read_pos = write_pos;
 }
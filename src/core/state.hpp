@@ -16,74 +16,77 @@
 #pragma once
 
 #include "core/types.hpp"
-#include "common/binary_file.hpp"
+#include "common/endian.hpp"
 
+#include <cstring>
 #include <vector>
 #include <string>
 
+// A snapshot of the emulator, kept in memory.
+//
+// The buffer is kept when the state is cleared, so after the first snapshot
+// it is already the right size, and saving is just a series of copies.
 class State
 {
 public:
-    virtual ~State() { }
+    State();
 
-    virtual void write8(u8 value)   = 0;
-    virtual void write16(u16 value) = 0;
-    virtual void write32(u32 value) = 0;
+    // Starts a new state, without freeing the buffer
+    void clear();
 
-    virtual void write_data(const void *data, unsigned int size) = 0; // Size is in bytes
+    unsigned int size() const;
+    bool is_empty() const;
 
-    virtual u8  read8 () = 0;
-    virtual u16 read16() = 0;
-    virtual u32 read32() = 0;
+    const u8 *get_data() const;
 
-    virtual void read_data(void *data, unsigned int size) = 0; // Size is in bytes
-};
+    int save_file(const std::string &file_path) const;
+    int load_file(const std::string &file_path);
 
-class State_File : public State
-{
-public:
-    int open_read (const std::string &file_path);
-    int open_write(const std::string &file_path);
-    void close();
+    inline void write8 (u8  value) { write_data(&value, sizeof(value)); }
+    inline void write16(u16 value) { value = little16(value); write_data(&value, sizeof(value)); }
+    inline void write32(u32 value) { value = little32(value); write_data(&value, sizeof(value)); }
 
-    void write8(u8 value)   override;
-    void write16(u16 value) override;
-    void write32(u32 value) override;
+    // Size is in bytes
+    inline void write_data(const void *data, unsigned int size) {
+        if (write_pos + size > memory.size())
+            grow(write_pos + size);
 
-    void write_data(const void *data, unsigned int size) override;;
+        std::memcpy(&memory[write_pos], data, size);
+        write_pos += size;
+    }
 
-    u8  read8 () override;
-    u16 read16() override;
-    u32 read32() override;
+    // Makes room for size bytes at the end of the state, and returns them to be written to directly
+    inline u8 *append(unsigned int size) {
+        if (write_pos + size > memory.size())
+            grow(write_pos + size);
 
-    void read_data(void *data, unsigned int size) override;
+        u8 *data = &memory[write_pos];
+        write_pos += size;
 
-private:
-    BinaryFile file;
-};
+        return data;
+    }
 
-class RewindSeries;
+    inline u8  read8 () { u8  value; read_data(&value, sizeof(value)); return value; }
+    inline u16 read16() { u16 value; read_data(&value, sizeof(value)); return little16(value); }
+    inline u32 read32() { u32 value; read_data(&value, sizeof(value)); return little32(value); }
 
-class State_Memory : public State
-{
-    friend RewindSeries;
-public:
-    unsigned int size() const;
-    bool is_empty() const;
-    void clear();
-
-    void write8(u8 value)   override;
-    void write16(u16 value) override;
-    void write32(u32 value) override;
+    // Size is in bytes
+    inline void read_data(void *data, unsigned int size) {
+        if (read_pos + size > write_pos) {
+            read_past_end(data, size);
+            return;
+        }
 
-    void write_data(const void *data, unsigned int size) override;
-
-    u8  read8 () override;
-    u16 read16() override;
-    u32 read32() override;
-
-    void read_data(void *data, unsigned int size) override;
+        std::memcpy(data, &memory[read_pos], size);
+        read_pos += size;
+    }
 
 private:
+    void grow(unsigned int size);
+    void read_past_end(void *data, unsigned int size);
+
     std::vector <u8> memory;
+
+    unsigned int write_pos; // Also the size of the state
+    unsigned int read_pos;
 };
@@ -17,7 +17,10 @@
 #include "common/logger.hpp"
 
 #include <SDL.h>
-#include <SDL_mutex.h>
+
+#include <algorithm>
+
+#define RING_MIN_FRAMES 8192 // Enough for a couple of frames, even in slow-motion
 
 static void audio_callback(void *userdata, Uint8 *stream, int len) {
     ((AudioSDL*)userdata)->callback(stream, len);
@@ -25,12 +28,21 @@ static void audio_callback(void *userdata, Uint8 *stream, int len) {
 
 AudioSDL::AudioSDL() {
     started = 0;
+
+    underruns = 0;
+    overruns  = 0;
 }
 
 int AudioSDL::start(unsigned int sample_rate, unsigned int buffer_size) {
     this->sample_rate = sample_rate;
     this->buffer_size = buffer_size;
 
+    // Room for what sync-to-audio lets build up, plus the blocks on the way
+    ring.reset(new SpscQueue<s16>(std::max(buffer_size * 4, (unsigned int)RING_MIN_FRAMES) * 2));
+
+    underruns = 0;
+    overruns  = 0;
+
     if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
         LOG_ERROR("Unable to initialize audio subsystem");
         return -1;
@@ -39,8 +51,6 @@ int AudioSDL::start(unsigned int sample_rate, unsigned int buffer_size) {
         LOG_DEBUG("Initialized audio subsystem");
     }
 
-    mutex = SDL_CreateMutex();
-
     SDL_AudioSpec desired;
     desired.freq     = sample_rate;
     desired.format   = AUDIO_S16SYS;
@@ -60,6 +70,12 @@ int AudioSDL::start(unsigned int sample_rate, unsigned int buffer_size) {
     else
         LOG_DEBUG("Opened audio-device");
 
+    // The device is allowed to pick another rate, and the resampler has to match it
+    if ((unsigned int)obtained.freq != sample_rate) {
+        LOG_NOTICE("Audio-device opened at " + std::to_string(obtained.freq) + " Hz instead of " + std::to_string(sample_rate) + " Hz");
+        this->sample_rate = obtained.freq;
+    }
+
     started = 1;
 
     return 0;
@@ -76,7 +92,7 @@ void AudioSDL::stop() {
 
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 
-    SDL_DestroyMutex(mutex);
+    ring.reset();
 
     LOG_DEBUG("Stopped audio-device");
 }
@@ -93,18 +109,27 @@ void AudioSDL::pause(bool value) {
 void AudioSDL::reset() {
     AudioDriver::reset();
 
+    if (!ring)
+        return;
+
+    // The callback isn't running while the device is locked
     SDL_LockAudioDevice(device_id);
-    audio_buffer.clear();
+    ring->clear();
     SDL_UnlockAudioDevice(device_id);
 }
 
 void AudioSDL::set_sync_to_audio(bool sync_to_audio) {
-    SDL_LockAudioDevice(device_id);
+    if (ring) {
+        SDL_LockAudioDevice(device_id);
 
-    audio_buffer.clear();
-    this->sync_to_audio = sync_to_audio;
+        ring->clear();
+        this->sync_to_audio = sync_to_audio;
 
-    SDL_UnlockAudioDevice(device_id);
+        SDL_UnlockAudioDevice(device_id);
+    }
+
+    else
+        this->sync_to_audio = sync_to_audio;
 
     if (sync_to_audio)
         LOG_DEBUG("Syncing emulation to audio");
@@ -113,30 +138,39 @@ void AudioSDL::set_sync_to_audio(bool sync_to_audio) {
 }
 
 void AudioSDL::callback(uint8_t *stream, int len) {
-    SDL_LockMutex(mutex);
-
     s16 *audio_stream = (s16*)stream;
     len >>= 1;
 
-    int size = audio_buffer.size();
+    int size = ring->pop_bulk(audio_stream, len);
 
-    if (size > len)
-        size = len;
-    else if (size < len)
+    if (size < len) {
         std::fill(audio_stream+size, audio_stream+len, 0);
-
-    std::copy(audio_buffer.begin(), audio_buffer.begin()+size, audio_stream);
-    audio_buffer.erase(audio_buffer.begin(), audio_buffer.begin()+size);
-
-    SDL_UnlockMutex(mutex);
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
-void AudioSDL::internal_add_sample(int16_t left, int16_t right) {
+void AudioSDL::internal_submit(const s16 *samples, std::size_t frames) {
+    // Not started, or already stopped
+    if (!ring)
+        return;
+
     if (sync_to_audio) {
-        while ((audio_buffer.size() >> 1) > buffer_size)
+        while ((ring->size() >> 1) > buffer_size)
             SDL_Delay(1);
     }
 
-    audio_buffer.push_back(left);
-    audio_buffer.push_back(right);
+    // Whatever doesn't fit is dropped, the ring has an even size so only whole frames are
+    if (ring->push_bulk(samples, frames*2) < frames*2)
+        overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+AudioDriver::BufferStats AudioSDL::get_buffer_stats() const {
+    BufferStats stats;
+
+    stats.fill      = ring ? ring->size() >> 1 : 0;
+    stats.capacity  = ring ? ring->capacity() >> 1 : 0;
+    stats.underruns = underruns.load(std::memory_order_relaxed);
+    stats.overruns  = overruns .load(std::memory_order_relaxed);
+
+    return stats;
 }
@@ -16,10 +16,11 @@
 #pragma once
 
 #include "core/audio/audio_driver.hpp"
+#include "common/spsc_queue.hpp"
 
+#include <atomic>
 #include <cstdint>
-
-struct SDL_mutex;
+#include <memory>
 
 class AudioSDL : public AudioDriver
 {
@@ -36,11 +37,17 @@ public:
 
     void callback(uint8_t *stream, int len);
 
+    BufferStats get_buffer_stats() const override;
+
 private:
-    void internal_add_sample(int16_t left, int16_t right) override;
+    void internal_submit(const s16 *samples, std::size_t frames) override;
 
     bool started;
     int device_id;
 
-    SDL_mutex *mutex;
+    // Interleaved samples, written by the emulation and read by the audio callback without any locking
+    std::unique_ptr<SpscQueue<s16>> ring;
+
+    std::atomic<unsigned int> underruns; // Counted by the audio callback
+    std::atomic<unsigned int> overruns;  // Counted by the emulation
 };
@@ -41,7 +41,10 @@
 #define MODIFIER KMOD_CTRL
 #endif
 
+#define FRAME_PERIOD (70224.0 / 4194304.0) // In seconds
+
 void print_usage(char *arg0, const std::vector <Option*> &options);
+std::string audio_stats_text(const AudioDriver &audio_driver);
 
 int load_rom_from_path(GameBoy &gb, const std::string &path, bool force_gb, bool force_gbc, bool dump_usage);
 int load_rom_from_dir(GameBoy &gb, std::string &path, RomList &rom_list, bool force_gb, bool force_gbc, bool dump_usage);
@@ -153,6 +156,9 @@ int main(int argc, char **argv) {
 
     bool running = 1, pause = 0, rewinding = 0;
     bool fullscreen = 0;
+    bool show_audio_stats = 0;
+
+    Uint64 next_frame = SDL_GetPerformanceCounter();
 
     unsigned int seconds = 0;
 
@@ -216,6 +222,7 @@ int main(int argc, char **argv) {
                             if (pause) {
                                 audio_driver.pause(1);
                                 audio_driver.set_mode(AudioDriver::Mode_Normal);
+                                gb.set_frame_skip(0);
 
                                 window.set_status_text("Paused", -1);
                                 LOG_DEBUG("Paused emulation");
@@ -228,6 +235,17 @@ int main(int argc, char **argv) {
                         }
                         break;
 
+                    case SDLK_i: // Audio statistics
+                        if (event.key.keysym.mod & MODIFIER) {
+                            show_audio_stats = !show_audio_stats;
+
+                            if (show_audio_stats)
+                                window.set_status_text(audio_stats_text(audio_driver), 2);
+                            else
+                                window.set_status_text("Hiding audio stats", 2);
+                        }
+                        break;
+
                     case SDLK_c: // Debugger Keyboard-Interrupt
                         if (event.key.keysym.mod & MODIFIER && debug_option.get_debug()) {
                             debugger.set_activated(1);
@@ -238,7 +256,11 @@ int main(int argc, char **argv) {
 
                     case SDLK_r: // Reset
                         if (event.key.keysym.mod) {
-                            gb.reset();
+                            if (gb.reset() < 0) {
+                                window.set_status_text("Can't reset", 2);
+                                break;
+                            }
+
                             gb.bind_input(input);
                             gb.bind_audio_driver(&audio_driver);
 
@@ -253,6 +275,7 @@ int main(int argc, char **argv) {
                     case SDLK_RSHIFT:
                         if (!pause) {
                             audio_driver.set_mode(AudioDriver::Mode_Turbo);
+                            gb.set_frame_skip(settings.video_turbo_frame_skip);
                             window.set_status_text("Turbo", -1);
                             LOG_DEBUG("Started running in turbo mode");
                         }
@@ -331,6 +354,7 @@ int main(int argc, char **argv) {
                     case SDLK_RSHIFT:
                         if (!pause) {
                             audio_driver.set_mode(AudioDriver::Mode_Normal);
+                            gb.set_frame_skip(0);
                             window.clear_status_text();
                             LOG_DEBUG("Stopped turbo mode");
                         }
@@ -442,9 +466,32 @@ int main(int argc, char **argv) {
             window.update(gb2.get_screen_buffer(), 1);
             window.show();
         }
-        else
+        else if (!gb.is_frame_skipped()) // Skipped frames are only drawn if they are asked for
             window.update(gb.get_screen_buffer());
 
+        // Without the audio to wait on, keep to the GameBoy's frame-rate here,
+        // and let the dynamic rate control keep the audio in step with it
+        if (!audio_driver.get_sync_to_audio() && audio_driver.get_mode() != AudioDriver::Mode_Turbo) {
+            double period = FRAME_PERIOD * (audio_driver.get_mode() == AudioDriver::Mode_SlowMotion ? 2 : 1);
+            Uint64 frequency = SDL_GetPerformanceFrequency();
+            Uint64 now = SDL_GetPerformanceCounter();
+
+            next_frame += period * frequency;
+
+            // Don't try to catch up after falling far behind
+            if (now > next_frame + period * frequency)
+                next_frame = now;
+
+            while (now < next_frame) {
+                Uint32 remaining = (next_frame - now) * 1000 / frequency;
+
+                if (remaining > 1)
+                    SDL_Delay(remaining - 1);
+
+                now = SDL_GetPerformanceCounter();
+            }
+        }
+
         frame_end = SDL_GetPerformanceCounter();
 
         elapsed_time += double(frame_end - frame_start) / double(SDL_GetPerformanceFrequency());
@@ -455,6 +502,9 @@ int main(int argc, char **argv) {
 
             window.set_title("Azayaka | " + gb.get_rom_name() + " | " + StringUtils::ftos(1.0/elapsed_time, 2) + " FPS");
 
+            if (show_audio_stats)
+                window.set_status_text(audio_stats_text(audio_driver), 2);
+
             elapsed_time  = 0.0;
             frame_counter = 0;
 
@@ -559,3 +609,19 @@ int load_rom_from_dir(GameBoy &gb, std::string &path, RomList &rom_list, bool fo
 
     return 0;
 }
+
+// Latency, ring fill, rate adjustment, underruns and overruns, short enough to fit across the screen
+std::string audio_stats_text(const AudioDriver &audio_driver) {
+    AudioDriver::BufferStats stats = audio_driver.get_buffer_stats();
+
+    int sample_rate = audio_driver.get_sample_rate();
+
+    // What is waiting in the ring, and the device's own buffer
+    int latency = sample_rate ? (stats.fill + audio_driver.get_buffer_size()) * 1000 / sample_rate : 0;
+    int fill    = stats.capacity ? stats.fill * 100 / stats.capacity : 0;
+
+    double adjust = audio_driver.get_rate_adjust() * 100.0;
+
+    return std::to_string(latency) + "ms " + std::to_string(fill) + "% " + (adjust < 0.0 ? "" : "+") + StringUtils::ftos(adjust, 2) + "% " +
+           "U" + std::to_string(stats.underruns) + " O" + std::to_string(stats.overruns);
+}
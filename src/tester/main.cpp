@@ -14,7 +14,9 @@
 // along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
 
 #include "core/gameboy.hpp"
+#include "core/cpu/cpu.hpp"
 #include "tester/results.hpp"
+#include "tester/thread_pool.hpp"
 #include "common/logger.hpp"
 #include "common/string_utils.hpp"
 #include "common/hash.hpp"
@@ -23,44 +25,92 @@
 
 #include <filesystem>
 #include <iostream>
+#include <fstream>
+#include <chrono>
 #include <ctime>
+#include <cstdlib>
 #include <algorithm>
+#include <thread>
+
+// How many frames to skip drawing in between, the recorded ones are kept until then
+#define FRAME_SKIP 15
 
 enum RomType {
     RomType_Blargg,
     RomType_Mooneye,
 };
 
-void test_rom(const std::string &base_path, RomType type);
-
-std::string sec_to_time(int time);
+struct TestJob {
+    std::string path;
+    std::string name; // Path relative to the test suite directory
+    RomType type;
 
-Results results;
+    bool loaded;
+    u32 old_checksum, new_checksum;
 
-const char status_wheel[] = {
-    '|', '/', '-', '|', '/', '-', '\\'
+    double time_ms; // Wall-clock time spent running the ROM
+    u64 cycles;     // Emulated clock cycles spent running the ROM
+    u64 idle_cycles; // Clock cycles skipped over in loops waiting for an event
 };
 
-unsigned int status_wheel_pos = 0;
+void find_roms(const std::string &base_path, RomType type, std::vector <TestJob> &jobs);
+void run_job(GameBoy &gb, TestJob &job);
+int save_timings(const std::string &file_path, const std::vector <TestJob> &jobs);
+
+std::string sec_to_time(int time);
+
+Results results;
 
 int main(int argc, char **argv) {
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <Test ROMs Path> <CSV Path>" << std::endl;
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <Test ROMs Path> <CSV Path> [Threads]" << std::endl;
         return -1;
     }
 
     if (results.init(std::string(argv[2])) < 0)
         std::cout << "Unable to load CSV!" << std::endl;
 
+    unsigned int num_of_threads = std::thread::hardware_concurrency();
+    if (argc == 4)
+        num_of_threads = std::atoi(argv[3]);
+
+    if (!num_of_threads)
+        num_of_threads = 1;
+
     Logger::get_instance().enable(0);
 
     time_t time_start = time(NULL);
 
-    std::cout << "Running Blargg tests" << std::endl;
-    test_rom(std::string(argv[1])+"/blargg", RomType_Blargg);
+    std::vector <TestJob> jobs;
+    find_roms(std::string(argv[1])+"/blargg",  RomType_Blargg,  jobs);
+    find_roms(std::string(argv[1])+"/mooneye", RomType_Mooneye, jobs);
+
+    std::cout << "Running " << jobs.size() << " tests on " << num_of_threads << " thread(s)" << std::endl;
+
+    // Every worker reuses the same GameBoy for all of its ROMs
+    ThreadPool pool(num_of_threads);
+    std::vector <GameBoy> gameboys(pool.get_num_of_workers());
 
-    std::cout << "Running Mooneye tests" << std::endl;
-    test_rom(std::string(argv[1])+"/mooneye", RomType_Mooneye);
+    // Only the last frame is saved, which is drawn when it's asked for
+    for (GameBoy &gb : gameboys)
+        gb.set_frame_skip(FRAME_SKIP);
+
+    pool.run(jobs.size(), [&](unsigned int job, unsigned int worker) {
+        run_job(gameboys[worker], jobs[job]);
+    });
+
+    // Report the results in the same order every time, regardless of which thread finished first
+    for (const TestJob &job : jobs) {
+        if (!job.loaded) {
+            std::cout << "Unable to load " << job.path << std::endl;
+            continue;
+        }
+
+        if (job.old_checksum != job.new_checksum)
+            std::cout << "\"" << File::remove_extension(job.path) << "\" changed! " << StringUtils::hex(job.new_checksum) << std::endl;
+
+        results.add_result(job.name, job.new_checksum);
+    }
 
     time_t time_end = time(NULL);
     std::cout << "All tests finished in " << sec_to_time(time_end-time_start) << std::endl;
@@ -68,19 +118,15 @@ int main(int argc, char **argv) {
     if (results.save_results("TestResults.md") < 0)
         std::cout << "Unable to save results!" << std::endl;
 
+    if (save_timings("TestTimings.csv", jobs) < 0)
+        std::cout << "Unable to save timings!" << std::endl;
+
     return 0;
 }
 
-void test_rom(const std::string &base_path, RomType type) {
-    status_wheel_pos = 0;
-
+void find_roms(const std::string &base_path, RomType type, std::vector <TestJob> &jobs) {
     int path_start = base_path.size()+1;
 
-    time_t time_start = time(NULL);
-
-    std::string path, bmp_path, error;
-    uint32_t old_checksum, new_checksum;
-
     std::vector <std::string> roms;
 
     // Find the ROMs
@@ -94,41 +140,77 @@ void test_rom(const std::string &base_path, RomType type) {
 
     std::sort(roms.begin(), roms.end());
 
-    for (unsigned int i = 0; i < roms.size(); i++) {
-        path = roms.at(i);
-        GameBoy gb;
+    for (const std::string &path : roms) {
+        TestJob job;
 
-        if (gb.load_rom(path, error) < 0) {
-            std::cout << "Unable to load " << path << std::endl;
-            continue;
-        }
+        job.path = path;
+        job.name = path.substr(path_start);
+        job.type = type;
 
-        gb.init();
+        job.loaded  = false;
+        job.old_checksum = job.new_checksum = 0;
+        job.time_ms = 0.0;
+        job.cycles  = 0;
+        job.idle_cycles = 0;
 
-        switch (type) {
-            case RomType_Blargg:
-                gb.run_until_blargg_done();
-                break;
+        jobs.push_back(job);
+    }
+}
 
-            case RomType_Mooneye:
-                gb.run_until_mooneye_done();
-                break;
-        }
+void run_job(GameBoy &gb, TestJob &job) {
+    std::string error;
 
-        bmp_path = File::remove_extension(path) + ".bmp";
+    auto time_start = std::chrono::steady_clock::now();
 
-        old_checksum = Common::crc32(bmp_path);
-        Common::save_bmp(bmp_path, gb.get_screen_buffer(), 160, 144);
-        new_checksum = Common::crc32(bmp_path);
+    if (gb.load_rom(job.path, error) < 0)
+        return;
 
-        if (old_checksum != new_checksum)
-            std::cout << "\"" << File::remove_extension(bmp_path) << "\" changed! " << StringUtils::hex(new_checksum) << std::endl;
+    gb.init();
 
-        results.add_result(path.substr(path_start), new_checksum);
+    switch (job.type) {
+        case RomType_Blargg:
+            gb.run_until_blargg_done();
+            break;
+
+        case RomType_Mooneye:
+            gb.run_until_mooneye_done();
+            break;
     }
 
-    time_t time_end = time(NULL);
-    std::cout << "Finished in " << sec_to_time(time_end-time_start) << "\n" << std::endl;
+    auto time_end = std::chrono::steady_clock::now();
+
+    job.loaded  = true;
+    job.time_ms = std::chrono::duration<double, std::milli>(time_end - time_start).count();
+    job.cycles  = gb.cpu->get_cycles();
+    job.idle_cycles = gb.cpu->get_idle_cycles();
+
+    std::string bmp_path = File::remove_extension(job.path) + ".bmp";
+
+    job.old_checksum = Common::crc32(bmp_path);
+    Common::save_bmp(bmp_path, gb.get_screen_buffer(), 160, 144);
+    job.new_checksum = Common::crc32(bmp_path);
+}
+
+int save_timings(const std::string &file_path, const std::vector <TestJob> &jobs) {
+    std::ofstream file(file_path);
+
+    if (!file.is_open())
+        return -1;
+
+    file << "type,name,ms,cycles,idle_cycles\n";
+
+    for (const TestJob &job : jobs) {
+        if (!job.loaded)
+            continue;
+
+        file << (job.type == RomType_Blargg ? "blargg" : "mooneye") << ','
+             << job.name << ','
+             << job.time_ms << ','
+             << job.cycles << ','
+             << job.idle_cycles << '\n';
+    }
+
+    return 0;
 }
 
 std::string sec_to_time(int time) {
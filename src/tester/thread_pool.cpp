@@ -0,0 +1,80 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#include "tester/thread_pool.hpp"
+
+#include <thread>
+
+ThreadPool::ThreadPool(unsigned int num_of_workers) : queues(num_of_workers ? num_of_workers : 1) {
+}
+
+unsigned int ThreadPool::get_num_of_workers() const {
+    return queues.size();
+}
+
+void ThreadPool::run(unsigned int num_of_jobs, const Job &job) {
+    // Deal the jobs out like cards, that way every worker starts
+    // with a similar mix of short and long jobs
+    for (unsigned int i = 0; i < num_of_jobs; i++)
+        queues[i % queues.size()].jobs.push_back(i);
+
+    std::vector <std::thread> threads;
+
+    for (unsigned int i = 1; i < queues.size(); i++)
+        threads.emplace_back(&ThreadPool::worker, this, i, std::cref(job));
+
+    // The calling thread works as well
+    worker(0, job);
+
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void ThreadPool::worker(unsigned int index, const Job &job) {
+    unsigned int current;
+
+    while (pop(index, current) || steal(index, current))
+        job(current, index);
+}
+
+bool ThreadPool::pop(unsigned int worker, unsigned int &job) {
+    WorkQueue &queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.jobs.empty())
+        return false;
+
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+
+    return true;
+}
+
+bool ThreadPool::steal(unsigned int worker, unsigned int &job) {
+    for (unsigned int i = 1; i < queues.size(); i++) {
+        WorkQueue &queue = queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.jobs.empty())
+            continue;
+
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2020-2022 Zach Collins <the_7thSamurai@protonmail.com>
+//
+// Azayaka is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Azayaka is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Azayaka. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Runs a fixed list of jobs across a number of worker threads.
+// Every worker owns a queue, and once it runs dry it steals
+// jobs from the back of the other workers queues.
+class ThreadPool
+{
+public:
+    // The job is given its index and the index of the worker running it
+    typedef std::function<void(unsigned int job, unsigned int worker)> Job;
+
+    ThreadPool(unsigned int num_of_workers);
+
+    unsigned int get_num_of_workers() const;
+
+    // Runs jobs 0 to (num_of_jobs-1), and blocks until all of them are done
+    void run(unsigned int num_of_jobs, const Job &job);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque <unsigned int> jobs;
+    };
+
+    void worker(unsigned int index, const Job &job);
+
+    bool pop  (unsigned int worker, unsigned int &job);
+    bool steal(unsigned int worker, unsigned int &job);
+
+    std::vector <WorkQueue> queues;
+};